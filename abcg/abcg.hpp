@@ -11,9 +11,18 @@
 #define ABCG_HPP_
 
 #include "abcg_application.hpp"
+#include "abcg_assetcache.hpp"
 #include "abcg_image.hpp"
+#include "abcg_meshcache.hpp"
+#include "abcg_meshoptimizer.hpp"
+#include "abcg_meshsimplifier.hpp"
+#include "abcg_meshwinding.hpp"
+#include "abcg_objreader.hpp"
 #include "abcg_openglwindow.hpp"
+#include "abcg_programreflection.hpp"
+#include "abcg_ringbuffer.hpp"
 #include "abcg_string.hpp"
 #include "abcg_trackball.hpp"
+#include "abcg_vertexwelder.hpp"
 
 #endif
\ No newline at end of file
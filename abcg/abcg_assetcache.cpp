@@ -0,0 +1,20 @@
+/**
+ * @file abcg_assetcache.cpp
+ * @brief Definition of abcg::AssetCache members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_assetcache.hpp"
+
+void abcg::AssetCache::erase(std::string_view path) {
+  m_assets.erase(std::string{path});
+}
+
+void abcg::AssetCache::clear() {
+  for (const auto &[key, program] : m_programs) {
+    abcg::glDeleteProgram(program);
+  }
+  m_programs.clear();
+  m_assets.clear();
+}
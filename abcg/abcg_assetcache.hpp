@@ -0,0 +1,122 @@
+/**
+ * @file abcg_assetcache.hpp
+ * @brief abcg::AssetCache header file.
+ *
+ * Cache of loaded assets keyed by path, so that shaders are compiled and
+ * models are parsed once per application run rather than once per call to
+ * initializeGL.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_ASSETCACHE_HPP_
+#define ABCG_ASSETCACHE_HPP_
+
+#include <fmt/core.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+
+#include "abcg_exception.hpp"
+#include "abcg_openglfunctions.hpp"
+
+namespace abcg {
+class AssetCache;
+}  // namespace abcg
+
+/**
+ * @brief Keeps compiled programs and loaded CPU-side assets alive by path.
+ *
+ * Each asset is loaded by a caller-supplied function the first time its
+ * path is requested; later requests return the same object. CPU-side assets
+ * are shared with the caller through std::shared_ptr, so a caller may keep
+ * using an asset after it leaves the cache. Programs are owned by the cache
+ * and deleted by clear(), which must therefore be called while the OpenGL
+ * context is current (typically in terminateGL).
+ */
+class abcg::AssetCache {
+ public:
+  AssetCache() = default;
+  AssetCache(const AssetCache &) = delete;
+  AssetCache &operator=(const AssetCache &) = delete;
+
+  /**
+   * @brief Returns the asset loaded from a path, loading it on first use.
+   *
+   * @tparam T Type of the asset.
+   * @param path Path or any other unique name of the asset.
+   * @param load Function returning the T loaded from path. Called only if
+   * the asset is not cached yet. If it throws, nothing is cached.
+   * @return Shared, immutable asset.
+   * @throw abcg::Exception if path was cached with a type other than T.
+   */
+  template <typename T, typename Load>
+  [[nodiscard]] std::shared_ptr<const T> get(std::string_view path,
+                                             Load &&load) {
+    std::string key{path};
+    if (const auto it{m_assets.find(key)}; it != m_assets.end()) {
+      if (it->second.type != std::type_index{typeid(T)}) {
+        throw abcg::Exception{abcg::Exception::Runtime(
+            fmt::format("Asset {} was cached with another type", path))};
+      }
+      return std::static_pointer_cast<const T>(it->second.asset);
+    }
+    auto asset{std::make_shared<const T>(std::invoke(std::forward<Load>(load)))};
+    m_assets.emplace(std::move(key), Entry{asset, typeid(T)});
+    return asset;
+  }
+
+  /**
+   * @brief Returns the program linked from a pair of shader files, creating
+   * it on first use.
+   *
+   * @param pathToVertexShader Path of the vertex shader.
+   * @param pathToFragmentShader Path of the fragment shader.
+   * @param create Function taking both paths and returning a new program,
+   * such as abcg::OpenGLWindow::createProgramFromFile. Called only if the
+   * pair is not cached yet.
+   * @return Program owned by the cache.
+   */
+  template <typename Create>
+  [[nodiscard]] GLuint program(std::string_view pathToVertexShader,
+                               std::string_view pathToFragmentShader,
+                               Create &&create) {
+    auto key{fmt::format("{}\n{}", pathToVertexShader, pathToFragmentShader)};
+    if (const auto it{m_programs.find(key)}; it != m_programs.end()) {
+      return it->second;
+    }
+    const GLuint program{std::invoke(std::forward<Create>(create),
+                                     pathToVertexShader, pathToFragmentShader)};
+    m_programs.emplace(std::move(key), program);
+    return program;
+  }
+
+  /**
+   * @brief Removes an asset from the cache, so that the next get() loads it
+   * again. Callers still holding it keep it alive.
+   *
+   * @param path Path the asset was cached with.
+   */
+  void erase(std::string_view path);
+
+  /**
+   * @brief Deletes all programs and releases all assets.
+   */
+  void clear();
+
+ private:
+  struct Entry {
+    std::shared_ptr<const void> asset;
+    std::type_index type;
+  };
+
+  std::unordered_map<std::string, Entry> m_assets;
+  std::unordered_map<std::string, GLuint> m_programs;
+};
+
+#endif
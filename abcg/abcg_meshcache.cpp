@@ -0,0 +1,281 @@
+/**
+ * @file abcg_meshcache.cpp
+ * @brief Definition of abcg::MappedFile and abcg::MeshCache members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_meshcache.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include "abcg_exception.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ABCG_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr std::array<char, 8> meshCacheMagic{'A', 'B', 'C', 'G', 'M', 'E', 'S', 'H'};
+constexpr std::uint32_t meshCacheVersion{4};
+
+// Fixed-size header. Its size and that of each level of detail entry are
+// multiples of 8, so the vertex array that follows them is suitably aligned for float and 32-bit integer attributes.
+// Vertex strides are expected to be multiples of the index size, which
+// keeps the index array aligned too.
+struct MeshCacheHeader {
+  std::array<char, 8> magic{meshCacheMagic};
+  std::uint32_t version{meshCacheVersion};
+  std::uint32_t vertexStride{};
+  std::uint64_t sourceHash{};
+  std::uint64_t processingVersion{};
+  std::uint64_t vertexCount{};
+  std::uint64_t indexCount{};
+  std::uint32_t indexSize{};
+  std::uint32_t lodCount{};
+};
+static_assert(sizeof(MeshCacheHeader) == 56);
+static_assert(sizeof(abcg::MeshLod) == 16);
+
+bool lodsInRange(std::span<const abcg::MeshLod> lods,
+                 std::uint64_t indexCount) noexcept {
+  return std::all_of(lods.begin(), lods.end(), [indexCount](const auto &lod) {
+    return std::uint64_t{lod.firstIndex} + lod.indexCount <= indexCount;
+  });
+}
+
+constexpr std::uint64_t mix(std::uint64_t value) noexcept {
+  value ^= value >> 31;
+  value *= 0xBF58476D1CE4E5B9ULL;
+  value ^= value >> 29;
+  return value;
+}
+}  // namespace
+
+std::uint64_t abcg::hashBytes(std::span<const std::byte> bytes,
+                              std::uint64_t seed) noexcept {
+  // Eight bytes per iteration: a few hundred microseconds for a mesh of a
+  // couple of megabytes
+  std::uint64_t hash{mix(seed ^ (bytes.size() * 0x9E3779B97F4A7C15ULL))};
+  std::size_t offset{0};
+  for (; offset + sizeof(std::uint64_t) <= bytes.size();
+       offset += sizeof(std::uint64_t)) {
+    std::uint64_t word{};
+    std::memcpy(&word, bytes.data() + offset, sizeof(word));
+    hash = (hash ^ mix(word)) * 0x9E3779B97F4A7C15ULL;
+  }
+  std::uint64_t tail{};
+  if (offset < bytes.size()) {
+    std::memcpy(&tail, bytes.data() + offset, bytes.size() - offset);
+  }
+  hash = (hash ^ mix(tail)) * 0x9E3779B97F4A7C15ULL;
+  return mix(hash);
+}
+
+std::uint64_t abcg::hashFile(std::string_view path, std::uint64_t seed) {
+  const MappedFile file{path};
+  if (!file.isOpen()) {
+    throw abcg::Exception{
+        abcg::Exception::Runtime(fmt::format("Failed to read {}", path))};
+  }
+  return hashBytes(file.bytes(), seed);
+}
+
+abcg::MappedFile::MappedFile(std::string_view path) {
+  const std::string pathString{path};
+#if defined(ABCG_MMAP)
+  const int descriptor{::open(pathString.c_str(), O_RDONLY)};
+  if (descriptor < 0) return;
+
+  struct stat status {};
+  if (::fstat(descriptor, &status) == 0 && status.st_size > 0) {
+    const auto size{static_cast<std::size_t>(status.st_size)};
+    void *address{::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0)};
+    if (address != MAP_FAILED) {
+      m_data = static_cast<const std::byte *>(address);
+      m_size = size;
+      m_mapped = true;
+    }
+  }
+  // The mapping stays valid after the descriptor is closed
+  ::close(descriptor);
+#else
+  std::ifstream stream{pathString, std::ios::binary | std::ios::ate};
+  if (!stream) return;
+  const auto size{static_cast<std::size_t>(stream.tellg())};
+  if (size == 0) return;
+  m_buffer.resize(size);
+  stream.seekg(0);
+  if (!stream.read(reinterpret_cast<char *>(m_buffer.data()),
+                   static_cast<std::streamsize>(size))) {
+    m_buffer.clear();
+    return;
+  }
+  m_data = m_buffer.data();
+  m_size = size;
+#endif
+}
+
+abcg::MappedFile::~MappedFile() { close(); }
+
+abcg::MappedFile::MappedFile(MappedFile &&other) noexcept {
+  *this = std::move(other);
+}
+
+abcg::MappedFile &abcg::MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    close();
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+    m_mapped = std::exchange(other.m_mapped, false);
+    m_buffer = std::move(other.m_buffer);
+  }
+  return *this;
+}
+
+void abcg::MappedFile::close() noexcept {
+#if defined(ABCG_MMAP)
+  if (m_mapped) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    ::munmap(const_cast<std::byte *>(m_data), m_size);
+  }
+#endif
+  m_data = nullptr;
+  m_size = 0;
+  m_mapped = false;
+  m_buffer.clear();
+}
+
+abcg::MeshCache abcg::MeshCache::load(std::string_view path,
+                                      std::uint64_t sourceHash,
+                                      std::uint64_t processingVersion,
+                                      std::size_t vertexStride) {
+  return loadChecked(path, &sourceHash, processingVersion, vertexStride);
+}
+
+abcg::MeshCache abcg::MeshCache::loadPrebuilt(std::string_view path,
+                                              std::uint64_t processingVersion,
+                                              std::size_t vertexStride) {
+  return loadChecked(path, nullptr, processingVersion, vertexStride);
+}
+
+abcg::MeshCache abcg::MeshCache::loadChecked(std::string_view path,
+                                             const std::uint64_t *sourceHash,
+                                             std::uint64_t processingVersion,
+                                             std::size_t vertexStride) {
+  MeshCache cache;
+  MappedFile file{path};
+  if (!file.isOpen()) return cache;
+
+  const auto bytes{file.bytes()};
+  MeshCacheHeader header;
+  if (bytes.size() < sizeof(header)) return cache;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+
+  if (header.magic != meshCacheMagic || header.version != meshCacheVersion ||
+      header.vertexStride != vertexStride ||
+      header.processingVersion != processingVersion ||
+      (header.indexSize != 2 && header.indexSize != 4) ||
+      (sourceHash != nullptr && header.sourceHash != *sourceHash)) {
+    return cache;
+  }
+
+  // The counts come from the file: each is bounded by the file size before
+  // being multiplied, so that a corrupted header cannot wrap the sizes below
+  // around and pass the size check
+  const auto fits{[&bytes](std::uint64_t count, std::size_t elementSize) {
+    return elementSize != 0 && count <= bytes.size() / elementSize;
+  }};
+  if (!fits(header.vertexCount, vertexStride) ||
+      !fits(header.indexCount, header.indexSize) ||
+      !fits(header.lodCount, sizeof(MeshLod))) {
+    return cache;
+  }
+
+  const auto vertexBytes{header.vertexCount * vertexStride};
+  const auto indexBytes{header.indexCount * header.indexSize};
+  const auto lodBytes{header.lodCount * sizeof(MeshLod)};
+  if (bytes.size() != sizeof(header) + lodBytes + vertexBytes + indexBytes) {
+    return cache;
+  }
+
+  const std::span lods{
+      reinterpret_cast<const MeshLod *>(bytes.data() + sizeof(header)),
+      header.lodCount};
+  if (!lodsInRange(lods, header.indexCount)) return cache;
+
+  cache.m_lods = lods;
+  cache.m_vertices = bytes.subspan(sizeof(header) + lodBytes, vertexBytes);
+  cache.m_indices =
+      bytes.subspan(sizeof(header) + lodBytes + vertexBytes, indexBytes);
+  cache.m_indexSize = header.indexSize;
+  cache.m_file = std::move(file);
+  return cache;
+}
+
+void abcg::MeshCache::save(std::string_view path, std::uint64_t sourceHash,
+                           std::uint64_t processingVersion,
+                           std::size_t vertexStride,
+                           std::span<const std::byte> vertices,
+                           std::span<const std::byte> indices,
+                           std::size_t indexSize,
+                           std::span<const MeshLod> lods) {
+  if (indexSize != 2 && indexSize != 4) {
+    throw abcg::Exception{abcg::Exception::Runtime(fmt::format(
+        "Failed to write mesh cache {} (invalid index size {})", path,
+        indexSize))};
+  }
+
+  MeshCacheHeader header;
+  header.vertexStride = static_cast<std::uint32_t>(vertexStride);
+  header.sourceHash = sourceHash;
+  header.processingVersion = processingVersion;
+  header.vertexCount = vertices.size() / vertexStride;
+  header.indexCount = indices.size() / indexSize;
+  header.indexSize = static_cast<std::uint32_t>(indexSize);
+  header.lodCount = static_cast<std::uint32_t>(lods.size());
+  if (!lodsInRange(lods, header.indexCount)) {
+    throw abcg::Exception{abcg::Exception::Runtime(fmt::format(
+        "Failed to write mesh cache {} (level of detail out of range)", path))};
+  }
+
+  // Write to a temporary file and rename it, so that a concurrent or
+  // interrupted run never sees a partially written cache
+  const std::string pathString{path};
+  const auto temporaryPath{pathString + ".tmp"};
+  {
+    std::ofstream stream{temporaryPath, std::ios::binary | std::ios::trunc};
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char *>(lods.data()),
+                 static_cast<std::streamsize>(lods.size_bytes()));
+    stream.write(reinterpret_cast<const char *>(vertices.data()),
+                 static_cast<std::streamsize>(vertices.size()));
+    stream.write(reinterpret_cast<const char *>(indices.data()),
+                 static_cast<std::streamsize>(indices.size()));
+    if (!stream) {
+      throw abcg::Exception{abcg::Exception::Runtime(
+          fmt::format("Failed to write mesh cache {}", path))};
+    }
+  }
+#if !defined(ABCG_MMAP)
+  // Only POSIX rename replaces an existing file
+  std::remove(pathString.c_str());
+#endif
+  if (std::rename(temporaryPath.c_str(), pathString.c_str()) != 0) {
+    std::remove(temporaryPath.c_str());
+    throw abcg::Exception{abcg::Exception::Runtime(
+        fmt::format("Failed to write mesh cache {}", path))};
+  }
+}
@@ -0,0 +1,223 @@
+/**
+ * @file abcg_meshcache.hpp
+ * @brief abcg::MappedFile and abcg::MeshCache header file.
+ *
+ * Binary cache of processed (deduplicated, transformed) indexed meshes, so
+ * that text formats such as OBJ are parsed only when the source changes.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_MESHCACHE_HPP_
+#define ABCG_MESHCACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace abcg {
+class MappedFile;
+class MeshCache;
+struct MeshLod;
+
+/**
+ * @brief Computes a 64-bit non-cryptographic hash of a sequence of bytes.
+ *
+ * @param bytes Bytes to hash.
+ * @param seed Value mixed into the hash. Use it to invalidate cached data
+ * when the processing that produced it changes.
+ * @return 64-bit hash value.
+ */
+[[nodiscard]] std::uint64_t hashBytes(std::span<const std::byte> bytes,
+                                      std::uint64_t seed = 0) noexcept;
+
+/**
+ * @brief Computes the hash of the contents of a file.
+ *
+ * @param path Path to the file.
+ * @param seed Value mixed into the hash (see abcg::hashBytes).
+ * @return 64-bit hash value.
+ *
+ * @throw abcg::Exception if the file cannot be read.
+ */
+[[nodiscard]] std::uint64_t hashFile(std::string_view path,
+                                     std::uint64_t seed = 0);
+}  // namespace abcg
+
+/**
+ * @brief Read-only view of the whole contents of a file.
+ *
+ * Uses a memory mapping on POSIX systems, so opening a file costs no copy
+ * and pages are read on first access. On other systems the file is read
+ * into memory.
+ */
+class abcg::MappedFile {
+ public:
+  MappedFile() = default;
+  /**
+   * @brief Opens and maps a file. Check isOpen() for success.
+   *
+   * @param path Path to the file.
+   */
+  explicit MappedFile(std::string_view path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  [[nodiscard]] bool isOpen() const noexcept { return m_data != nullptr; }
+  [[nodiscard]] std::span<const std::byte> bytes() const noexcept {
+    return {m_data, m_size};
+  }
+
+ private:
+  const std::byte *m_data{};
+  std::size_t m_size{};
+  bool m_mapped{};
+  std::vector<std::byte> m_buffer;
+
+  void close() noexcept;
+};
+
+/**
+ * @brief Level of detail of a mesh: a range of its index array.
+ *
+ */
+struct abcg::MeshLod {
+  /** @brief Position of the first index of the level in the index array. */
+  std::uint32_t firstIndex{};
+  /** @brief Number of indices of the level. */
+  std::uint32_t indexCount{};
+  /** @brief Largest distance from a vertex of the level to the planes of
+   * the full-detail triangles it replaced, in position units. */
+  double error{};
+};
+
+/**
+ * @brief Binary file with the vertices and indices of an indexed mesh.
+ *
+ * The file has a fixed-size header (magic number, version, vertex stride,
+ * hash of the source asset, processing version, element counts and index
+ * size) followed by an
+ * optional table of levels of detail, the raw vertex array and the index
+ * array, with 16-bit or 32-bit indices. Loading maps the file and validates the
+ * header; vertices() and indices() point straight into the mapping, so the
+ * data can be uploaded to buffer objects without parsing or copying.
+ *
+ * A cache is valid only while the object that loaded it is alive.
+ */
+class abcg::MeshCache {
+ public:
+  MeshCache() = default;
+
+  /**
+   * @brief Loads a mesh cache file.
+   *
+   * @param path Path to the cache file.
+   * @param sourceHash Expected hash of the source asset.
+   * @param processingVersion Expected version of the processing that
+   * produced the mesh from its source.
+   * @param vertexStride Expected size of each vertex, in bytes.
+   * @return Loaded cache. It is invalid (see isValid()) if the file does not
+   * exist, is truncated, or was written from a different source, by a
+   * different processing version or with a different vertex layout.
+   */
+  [[nodiscard]] static MeshCache load(std::string_view path,
+                                      std::uint64_t sourceHash,
+                                      std::uint64_t processingVersion,
+                                      std::size_t vertexStride);
+
+  /**
+   * @brief Loads a mesh cache file regardless of the source it was made from.
+   *
+   * Meant for prebuilt caches shipped without their source asset. The
+   * processing version is still checked, so a cache baked by an older
+   * pipeline is rejected instead of being drawn with a layout or set of
+   * levels of detail the application no longer expects.
+   *
+   * @param path Path to the cache file.
+   * @param processingVersion Expected version of the processing that
+   * produced the mesh.
+   * @param vertexStride Expected size of each vertex, in bytes.
+   * @return Loaded cache, invalid if the file does not exist, is truncated,
+   * or has a different processing version or vertex layout.
+   */
+  [[nodiscard]] static MeshCache loadPrebuilt(std::string_view path,
+                                              std::uint64_t processingVersion,
+                                              std::size_t vertexStride);
+
+  /**
+   * @brief Writes a mesh cache file.
+   *
+   * @param path Path to the cache file.
+   * @param sourceHash Hash of the source asset.
+   * @param processingVersion Version of the processing that produced the
+   * mesh from its source.
+   * @param vertexStride Size of each vertex, in bytes.
+   * @param vertices Raw bytes of the vertex array.
+   * @param indices Raw bytes of the index array.
+   * @param indexSize Size of each index, in bytes (2 or 4).
+   * @param lods Levels of detail, as ranges of the index array.
+   *
+   * @throw abcg::Exception if the index size is not 2 or 4, if a level of
+   * detail is out of range, or if the file cannot be written.
+   */
+  static void save(std::string_view path, std::uint64_t sourceHash,
+                   std::uint64_t processingVersion, std::size_t vertexStride,
+                   std::span<const std::byte> vertices,
+                   std::span<const std::byte> indices, std::size_t indexSize,
+                   std::span<const MeshLod> lods = {});
+
+  [[nodiscard]] bool isValid() const noexcept { return m_file.isOpen(); }
+
+  /**
+   * @brief Vertex array reinterpreted as an array of T.
+   *
+   * @tparam T Vertex type, whose size must be the stride given to load().
+   */
+  template <typename T>
+  [[nodiscard]] std::span<const T> vertices() const noexcept {
+    return {reinterpret_cast<const T *>(m_vertices.data()),
+            m_vertices.size() / sizeof(T)};
+  }
+  [[nodiscard]] std::span<const std::byte> vertexBytes() const noexcept {
+    return m_vertices;
+  }
+  /**
+   * @brief Index array reinterpreted as an array of T.
+   *
+   * @tparam T Index type, whose size must be indexSize().
+   */
+  template <typename T>
+  [[nodiscard]] std::span<const T> indices() const noexcept {
+    return {reinterpret_cast<const T *>(m_indices.data()),
+            m_indices.size() / sizeof(T)};
+  }
+  [[nodiscard]] std::span<const std::byte> indexBytes() const noexcept {
+    return m_indices;
+  }
+  /** @brief Size of each index, in bytes: 2 or 4. */
+  [[nodiscard]] std::size_t indexSize() const noexcept { return m_indexSize; }
+  /** @brief Levels of detail, empty if the file has none. */
+  [[nodiscard]] std::span<const MeshLod> lods() const noexcept {
+    return m_lods;
+  }
+
+ private:
+  [[nodiscard]] static MeshCache loadChecked(std::string_view path,
+                                             const std::uint64_t *sourceHash,
+                                             std::uint64_t processingVersion,
+                                             std::size_t vertexStride);
+
+  MappedFile m_file;
+  std::span<const std::byte> m_vertices;
+  std::span<const std::byte> m_indices;
+  std::size_t m_indexSize{};
+  std::span<const MeshLod> m_lods;
+};
+
+#endif
@@ -0,0 +1,330 @@
+/**
+ * @file abcg_meshoptimizer.cpp
+ * @brief Definition of mesh optimization functions.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_meshoptimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <numeric>
+
+namespace {
+constexpr auto invalidIndex{std::numeric_limits<std::uint32_t>::max()};
+
+// FIFO cache: a vertex is cached if fewer than size misses happened since
+// it was last loaded
+class FifoCache {
+ public:
+  FifoCache(std::size_t vertexCount, std::size_t size)
+      : m_loadTime(vertexCount, 0),
+        m_size{static_cast<std::uint32_t>(size)},
+        m_timestamp{m_size + 1} {}
+
+  // Returns true on a miss
+  bool access(std::uint32_t vertex) noexcept {
+    if (m_timestamp - m_loadTime[vertex] > m_size) {
+      m_loadTime[vertex] = m_timestamp++;
+      return true;
+    }
+    return false;
+  }
+
+  std::size_t accessTriangle(const std::uint32_t *triangle) noexcept {
+    return static_cast<std::size_t>(access(triangle[0])) +
+           static_cast<std::size_t>(access(triangle[1])) +
+           static_cast<std::size_t>(access(triangle[2]));
+  }
+
+  void flush() noexcept { m_timestamp += m_size + 1; }
+
+ private:
+  std::vector<std::uint32_t> m_loadTime;
+  std::uint32_t m_size;
+  std::uint32_t m_timestamp;
+};
+
+// Triangles around each vertex, in compressed sparse row layout
+struct Adjacency {
+  std::vector<std::uint32_t> offsets;  // vertexCount + 1 entries
+  std::vector<std::uint32_t> triangles;
+
+  Adjacency(std::span<const std::uint32_t> indices, std::size_t vertexCount)
+      : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+    for (const auto vertex : indices) ++offsets[vertex + 1];
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    auto next{offsets};
+    for (std::size_t corner{0}; corner < indices.size(); ++corner) {
+      triangles[next[indices[corner]]++] =
+          static_cast<std::uint32_t>(corner / 3);
+    }
+  }
+
+  [[nodiscard]] std::span<const std::uint32_t> around(
+      std::uint32_t vertex) const noexcept {
+    return {triangles.data() + offsets[vertex],
+            triangles.data() + offsets[vertex + 1]};
+  }
+};
+
+struct Vec3 {
+  double x{}, y{}, z{};
+};
+
+Vec3 positionOf(const float *positions, std::size_t stride,
+                std::uint32_t vertex) noexcept {
+  std::array<float, 3> p{};
+  std::memcpy(p.data(),
+              reinterpret_cast<const std::byte *>(positions) + vertex * stride,
+              sizeof(p));
+  return {p[0], p[1], p[2]};
+}
+}  // namespace
+
+abcg::VertexCacheStatistics abcg::analyzeVertexCache(
+    std::span<const std::uint32_t> indices, std::size_t vertexCount,
+    std::size_t cacheSize) {
+  VertexCacheStatistics statistics;
+  if (indices.empty()) return statistics;
+
+  FifoCache cache{vertexCount, cacheSize};
+  for (std::size_t corner{0}; corner + 2 < indices.size(); corner += 3) {
+    statistics.transformedVertices += cache.accessTriangle(&indices[corner]);
+  }
+
+  std::vector<bool> referenced(vertexCount, false);
+  for (const auto vertex : indices) referenced[vertex] = true;
+  const auto referencedCount{
+      std::count(referenced.begin(), referenced.end(), true)};
+
+  statistics.acmr = static_cast<float>(statistics.transformedVertices) /
+                    static_cast<float>(indices.size() / 3);
+  statistics.atvr = static_cast<float>(statistics.transformedVertices) /
+                    static_cast<float>(referencedCount);
+  return statistics;
+}
+
+void abcg::optimizeVertexCache(std::span<std::uint32_t> indices,
+                               std::size_t vertexCount, std::size_t cacheSize) {
+  const auto triangleCount{indices.size() / 3};
+  if (triangleCount == 0) return;
+
+  const Adjacency adjacency{indices, vertexCount};
+  std::vector<std::uint32_t> liveTriangles(vertexCount);
+  for (std::uint32_t vertex{0}; vertex < vertexCount; ++vertex) {
+    liveTriangles[vertex] =
+        adjacency.offsets[vertex + 1] - adjacency.offsets[vertex];
+  }
+
+  // Same timing rule as FifoCache, kept inline to read the load times
+  const auto size{static_cast<std::int64_t>(cacheSize)};
+  std::vector<std::int64_t> loadTime(vertexCount, 0);
+  std::int64_t timestamp{size + 1};
+
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<std::uint32_t> deadEnds;
+  std::vector<std::uint32_t> candidates;
+  std::vector<std::uint32_t> output;
+  output.reserve(indices.size());
+  std::uint32_t cursor{0};
+
+  // Last resort when the fan of the current vertex has no good successor:
+  // a recently used vertex that still has triangles, or else the next one in
+  // input order
+  auto skipDeadEnd{[&]() -> std::uint32_t {
+    while (!deadEnds.empty()) {
+      const auto vertex{deadEnds.back()};
+      deadEnds.pop_back();
+      if (liveTriangles[vertex] > 0) return vertex;
+    }
+    while (cursor < vertexCount) {
+      if (liveTriangles[cursor] > 0) return cursor;
+      ++cursor;
+    }
+    return invalidIndex;
+  }};
+
+  auto fanning{skipDeadEnd()};
+  while (fanning != invalidIndex) {
+    // Emit every remaining triangle around the fanning vertex
+    candidates.clear();
+    for (const auto triangle : adjacency.around(fanning)) {
+      if (emitted[triangle]) continue;
+      emitted[triangle] = true;
+      for (std::size_t corner{0}; corner < 3; ++corner) {
+        const auto vertex{indices[triangle * 3 + corner]};
+        output.push_back(vertex);
+        deadEnds.push_back(vertex);
+        candidates.push_back(vertex);
+        --liveTriangles[vertex];
+        if (timestamp - loadTime[vertex] > size) loadTime[vertex] = timestamp++;
+      }
+    }
+
+    // Next fanning vertex: the oldest candidate that will still be in the
+    // cache after its own remaining triangles are emitted
+    auto next{invalidIndex};
+    std::int64_t bestPriority{-1};
+    for (const auto vertex : candidates) {
+      if (liveTriangles[vertex] == 0) continue;
+      std::int64_t priority{0};
+      if (timestamp - loadTime[vertex] + 2 * std::int64_t{liveTriangles[vertex]} <=
+          size) {
+        priority = timestamp - loadTime[vertex];
+      }
+      if (priority > bestPriority) {
+        bestPriority = priority;
+        next = vertex;
+      }
+    }
+    fanning = next != invalidIndex ? next : skipDeadEnd();
+  }
+
+  std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void abcg::optimizeOverdraw(std::span<std::uint32_t> indices,
+                            const float *positions, std::size_t vertexCount,
+                            std::size_t positionStride, float threshold,
+                            std::size_t cacheSize) {
+  const auto triangleCount{indices.size() / 3};
+  if (triangleCount < 2) return;
+
+  // Hard boundaries: triangles whose three vertices all miss the cache
+  std::vector<std::size_t> hardBoundaries;
+  {
+    FifoCache cache{vertexCount, cacheSize};
+    for (std::size_t triangle{0}; triangle < triangleCount; ++triangle) {
+      if (cache.accessTriangle(&indices[triangle * 3]) == 3) {
+        hardBoundaries.push_back(triangle);
+      }
+    }
+  }
+  hardBoundaries.push_back(triangleCount);
+
+  // Soft boundaries: split each cluster as soon as its prefix, simulated
+  // from an empty cache, is within threshold of the cluster's own ACMR
+  std::vector<std::size_t> clusters;
+  {
+    FifoCache cache{vertexCount, cacheSize};
+    for (std::size_t i{0}; i + 1 < hardBoundaries.size(); ++i) {
+      const auto begin{hardBoundaries[i]};
+      const auto end{hardBoundaries[i + 1]};
+
+      cache.flush();
+      std::size_t clusterMisses{0};
+      for (auto triangle{begin}; triangle < end; ++triangle) {
+        clusterMisses += cache.accessTriangle(&indices[triangle * 3]);
+      }
+      const auto limit{threshold * static_cast<float>(clusterMisses) /
+                       static_cast<float>(end - begin)};
+
+      cache.flush();
+      auto start{begin};
+      std::size_t misses{0};
+      clusters.push_back(begin);
+      for (auto triangle{begin}; triangle + 1 < end; ++triangle) {
+        misses += cache.accessTriangle(&indices[triangle * 3]);
+        if (static_cast<float>(misses) /
+                static_cast<float>(triangle + 1 - start) <=
+            limit) {
+          start = triangle + 1;
+          misses = 0;
+          cache.flush();
+          clusters.push_back(start);
+        }
+      }
+    }
+  }
+  const auto clusterCount{clusters.size()};
+  clusters.push_back(triangleCount);
+
+  // Area-weighted centroid and normal of each cluster and of the mesh
+  std::vector<Vec3> centroids(clusterCount);
+  std::vector<Vec3> normals(clusterCount);
+  std::vector<double> areas(clusterCount, 0.0);
+  Vec3 meshCentroid;
+  double meshArea{0.0};
+  for (std::size_t cluster{0}; cluster < clusterCount; ++cluster) {
+    for (auto triangle{clusters[cluster]}; triangle < clusters[cluster + 1];
+         ++triangle) {
+      const auto a{positionOf(positions, positionStride, indices[triangle * 3])};
+      const auto b{
+          positionOf(positions, positionStride, indices[triangle * 3 + 1])};
+      const auto c{
+          positionOf(positions, positionStride, indices[triangle * 3 + 2])};
+      const Vec3 ab{b.x - a.x, b.y - a.y, b.z - a.z};
+      const Vec3 ac{c.x - a.x, c.y - a.y, c.z - a.z};
+      const Vec3 normal{ab.y * ac.z - ab.z * ac.y, ab.z * ac.x - ab.x * ac.z,
+                        ab.x * ac.y - ab.y * ac.x};
+      const auto area{
+          std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z)};
+
+      auto &centroid{centroids[cluster]};
+      centroid.x += area * (a.x + b.x + c.x) / 3.0;
+      centroid.y += area * (a.y + b.y + c.y) / 3.0;
+      centroid.z += area * (a.z + b.z + c.z) / 3.0;
+      normals[cluster].x += normal.x;
+      normals[cluster].y += normal.y;
+      normals[cluster].z += normal.z;
+      areas[cluster] += area;
+    }
+    meshCentroid.x += centroids[cluster].x;
+    meshCentroid.y += centroids[cluster].y;
+    meshCentroid.z += centroids[cluster].z;
+    meshArea += areas[cluster];
+  }
+  if (meshArea > 0.0) {
+    meshCentroid = {meshCentroid.x / meshArea, meshCentroid.y / meshArea,
+                    meshCentroid.z / meshArea};
+  }
+
+  std::vector<double> sortKeys(clusterCount, 0.0);
+  for (std::size_t cluster{0}; cluster < clusterCount; ++cluster) {
+    const auto &n{normals[cluster]};
+    const auto length{std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z)};
+    if (areas[cluster] <= 0.0 || length <= 0.0) continue;
+    const auto &c{centroids[cluster]};
+    sortKeys[cluster] = ((c.x / areas[cluster] - meshCentroid.x) * n.x +
+                         (c.y / areas[cluster] - meshCentroid.y) * n.y +
+                         (c.z / areas[cluster] - meshCentroid.z) * n.z) /
+                        length;
+  }
+
+  // Outermost clusters first
+  std::vector<std::size_t> order(clusterCount);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](auto lhs, auto rhs) {
+    return sortKeys[lhs] > sortKeys[rhs];
+  });
+
+  std::vector<std::uint32_t> output;
+  output.reserve(indices.size());
+  for (const auto cluster : order) {
+    output.insert(
+        output.end(),
+        std::next(indices.begin(),
+                  static_cast<std::ptrdiff_t>(clusters[cluster] * 3)),
+        std::next(indices.begin(),
+                  static_cast<std::ptrdiff_t>(clusters[cluster + 1] * 3)));
+  }
+  std::copy(output.begin(), output.end(), indices.begin());
+}
+
+std::vector<std::uint32_t> abcg::optimizeVertexFetch(
+    std::span<std::uint32_t> indices, std::size_t vertexCount) {
+  std::vector<std::uint32_t> remap(vertexCount, invalidIndex);
+  std::uint32_t next{0};
+  for (auto &index : indices) {
+    if (remap[index] == invalidIndex) remap[index] = next++;
+    index = remap[index];
+  }
+  return remap;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file abcg_meshoptimizer.hpp
+ * @brief Declaration of mesh optimization functions.
+ *
+ * Reordering of indexed triangle meshes for the post-transform vertex
+ * cache, for overdraw and for vertex fetch locality.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_MESHOPTIMIZER_HPP_
+#define ABCG_MESHOPTIMIZER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace abcg {
+struct VertexCacheStatistics;
+
+/**
+ * @brief Simulates a FIFO post-transform vertex cache over a triangle list.
+ *
+ * @param indices Triangle list, three indices per triangle.
+ * @param vertexCount Number of vertices in the vertex array.
+ * @param cacheSize Number of vertices kept in the simulated cache.
+ * @return Cache statistics of the triangle list.
+ */
+[[nodiscard]] VertexCacheStatistics analyzeVertexCache(
+    std::span<const std::uint32_t> indices, std::size_t vertexCount,
+    std::size_t cacheSize = 16);
+
+/**
+ * @brief Reorders triangles to reduce post-transform vertex cache misses.
+ *
+ * Implements Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering
+ * for Vertex Locality and Reduced Overdraw", 2007), which runs in time
+ * linear in the number of triangles. The winding of each triangle is kept.
+ *
+ * @param indices Triangle list, reordered in place.
+ * @param vertexCount Number of vertices in the vertex array.
+ * @param cacheSize Size of the cache the order is tuned for.
+ */
+void optimizeVertexCache(std::span<std::uint32_t> indices,
+                         std::size_t vertexCount, std::size_t cacheSize = 16);
+
+/**
+ * @brief Reorders clusters of triangles so that outer, outward-facing
+ * clusters are drawn first, reducing overdraw with depth testing.
+ *
+ * Expects a triangle list already ordered by optimizeVertexCache. The list
+ * is split into clusters where the cache order starts over (every vertex of
+ * a triangle misses) and, within those, where the running miss ratio drops
+ * to threshold times that of the whole cluster. Clusters are then sorted by
+ * how far their centroid lies along their average normal from the mesh
+ * centroid, as in the paper above. The order within each cluster is kept,
+ * so the ACMR stays close to that of the input (clusters only lose the
+ * vertices they shared through the cache with their predecessors).
+ *
+ * @param indices Triangle list, reordered in place.
+ * @param positions Vertex positions, three floats (x, y, z) per vertex.
+ * @param vertexCount Number of vertices in the vertex array.
+ * @param positionStride Distance between the positions of consecutive
+ * vertices, in bytes.
+ * @param threshold ACMR increase accepted when splitting a cluster, as a
+ * factor. Larger values give smaller clusters and less overdraw.
+ * @param cacheSize Size of the cache the order was tuned for.
+ */
+void optimizeOverdraw(std::span<std::uint32_t> indices, const float *positions,
+                      std::size_t vertexCount, std::size_t positionStride,
+                      float threshold = 1.05f, std::size_t cacheSize = 16);
+
+/**
+ * @brief Renumbers vertices in the order the triangle list first uses them,
+ * so that vertex fetches walk the vertex array sequentially.
+ *
+ * @param indices Triangle list, whose indices are rewritten in place.
+ * @param vertexCount Number of vertices in the vertex array.
+ * @return Remap table: the new index of each old vertex, or UINT32_MAX for
+ * vertices no triangle uses. Vertex i must be moved to position remap[i].
+ */
+[[nodiscard]] std::vector<std::uint32_t> optimizeVertexFetch(
+    std::span<std::uint32_t> indices, std::size_t vertexCount);
+}  // namespace abcg
+
+/**
+ * @brief Result of abcg::analyzeVertexCache.
+ *
+ */
+struct abcg::VertexCacheStatistics {
+  /** @brief Number of vertex shader invocations (cache misses). */
+  std::size_t transformedVertices{};
+  /** @brief Average cache miss ratio: misses per triangle (0.5 to 3). */
+  float acmr{};
+  /** @brief Average transform to vertex ratio: misses per referenced
+   * vertex (1 is optimal). */
+  float atvr{};
+};
+
+#endif
@@ -0,0 +1,276 @@
+/**
+ * @file abcg_meshsimplifier.cpp
+ * @brief Definition of abcg::simplifyMesh.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_meshsimplifier.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace {
+struct Vec3 {
+  double x{}, y{}, z{};
+
+  Vec3 operator-(const Vec3 &other) const noexcept {
+    return {x - other.x, y - other.y, z - other.z};
+  }
+};
+
+Vec3 cross(const Vec3 &a, const Vec3 &b) noexcept {
+  return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+double dot(const Vec3 &a, const Vec3 &b) noexcept {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+// Symmetric 4x4 matrix of the sum of squared distances to a set of planes,
+// plus the total weight of those planes
+struct Quadric {
+  double a00{}, a01{}, a02{}, a11{}, a12{}, a22{};
+  double b0{}, b1{}, b2{};
+  double c{};
+  double weight{};
+
+  static Quadric fromPlane(const Vec3 &normal, double distance,
+                           double weight) noexcept {
+    const auto &n{normal};
+    return {n.x * n.x * weight,
+            n.x * n.y * weight,
+            n.x * n.z * weight,
+            n.y * n.y * weight,
+            n.y * n.z * weight,
+            n.z * n.z * weight,
+            n.x * distance * weight,
+            n.y * distance * weight,
+            n.z * distance * weight,
+            distance * distance * weight,
+            weight};
+  }
+
+  Quadric &operator+=(const Quadric &other) noexcept {
+    a00 += other.a00;
+    a01 += other.a01;
+    a02 += other.a02;
+    a11 += other.a11;
+    a12 += other.a12;
+    a22 += other.a22;
+    b0 += other.b0;
+    b1 += other.b1;
+    b2 += other.b2;
+    c += other.c;
+    weight += other.weight;
+    return *this;
+  }
+
+  // Weighted mean of the squared distances from p to the planes. Never more
+  // than the square of the largest distance, so it ranks collapses and
+  // rejects them early, but understates how far the surface moves
+  [[nodiscard]] double error(const Vec3 &p) const noexcept {
+    const auto sum{p.x * (a00 * p.x + 2.0 * (a01 * p.y + a02 * p.z + b0)) +
+                   p.y * (a11 * p.y + 2.0 * (a12 * p.z + b1)) +
+                   p.z * (a22 * p.z + 2.0 * b2) + c};
+    return weight > 0.0 ? std::max(sum, 0.0) / weight : 0.0;
+  }
+};
+
+struct Plane {
+  Vec3 normal;
+  double distance{};
+
+  [[nodiscard]] double distanceTo(const Vec3 &p) const noexcept {
+    return std::abs(dot(normal, p) + distance);
+  }
+};
+
+struct Collapse {
+  std::uint32_t from{};
+  std::uint32_t to{};
+  double error{};
+};
+
+// Triangles around each vertex, in compressed sparse row layout
+void buildAdjacency(const std::vector<std::uint32_t> &indices,
+                    std::size_t vertexCount,
+                    std::vector<std::uint32_t> &offsets,
+                    std::vector<std::uint32_t> &triangles) {
+  offsets.assign(vertexCount + 1, 0);
+  for (const auto vertex : indices) ++offsets[vertex + 1];
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  triangles.resize(indices.size());
+  auto next{offsets};
+  for (std::size_t corner{0}; corner < indices.size(); ++corner) {
+    triangles[next[indices[corner]]++] = static_cast<std::uint32_t>(corner / 3);
+  }
+}
+}  // namespace
+
+std::vector<std::uint32_t> abcg::simplifyMesh(
+    std::span<const std::uint32_t> indices, const float *positions,
+    std::size_t vertexCount, std::size_t positionStride,
+    std::size_t targetIndexCount, float targetError, float *resultError) {
+  std::vector<std::uint32_t> result(indices.begin(), indices.end());
+  if (resultError != nullptr) *resultError = 0.0f;
+  if (result.size() <= targetIndexCount) return result;
+
+  std::vector<Vec3> points(vertexCount);
+  for (std::size_t vertex{0}; vertex < vertexCount; ++vertex) {
+    std::array<float, 3> p{};
+    std::memcpy(p.data(),
+                reinterpret_cast<const std::byte *>(positions) +
+                    vertex * positionStride,
+                sizeof(p));
+    points[vertex] = {p[0], p[1], p[2]};
+  }
+
+  // Besides its quadric, each vertex keeps the original planes it merged, to
+  // measure the largest distance a collapse moves it from them
+  std::vector<Quadric> quadrics(vertexCount);
+  std::vector<Plane> planes;
+  std::vector<std::vector<std::uint32_t>> planesOf(vertexCount);
+  for (std::size_t corner{0}; corner < result.size(); corner += 3) {
+    const auto &a{points[result[corner]]};
+    const auto normal{cross(points[result[corner + 1]] - a,
+                            points[result[corner + 2]] - a)};
+    const auto length{std::sqrt(dot(normal, normal))};
+    if (length <= 0.0) continue;
+    const Vec3 unit{normal.x / length, normal.y / length, normal.z / length};
+    const auto quadric{Quadric::fromPlane(unit, -dot(unit, a), length * 0.5)};
+    const auto plane{static_cast<std::uint32_t>(planes.size())};
+    planes.push_back({unit, -dot(unit, a)});
+    for (std::size_t i{0}; i < 3; ++i) {
+      quadrics[result[corner + i]] += quadric;
+      planesOf[result[corner + i]].push_back(plane);
+    }
+  }
+  const auto largestDistance{[&](std::uint32_t vertex, const Vec3 &p) {
+    double distance{0.0};
+    for (const auto plane : planesOf[vertex]) {
+      distance = std::max(distance, planes[plane].distanceTo(p));
+    }
+    return distance;
+  }};
+
+  // Vertices on open edges are locked: an edge is open if no triangle has it
+  // in the opposite direction
+  std::vector<bool> locked(vertexCount, false);
+  {
+    std::vector<std::uint64_t> edges;
+    edges.reserve(result.size());
+    for (std::size_t corner{0}; corner < result.size(); ++corner) {
+      const auto from{result[corner]};
+      const auto to{result[corner - corner % 3 + (corner + 1) % 3]};
+      edges.push_back(std::uint64_t{from} << 32 | to);
+    }
+    std::sort(edges.begin(), edges.end());
+    for (const auto edge : edges) {
+      const auto reversed{edge << 32 | edge >> 32};
+      if (!std::binary_search(edges.begin(), edges.end(), reversed)) {
+        locked[edge >> 32] = true;
+        locked[edge & 0xFFFFFFFFU] = true;
+      }
+    }
+  }
+
+  const auto limit{static_cast<double>(targetError)};
+  const auto maxError{limit * limit};
+  // Largest distance from a moved vertex to the original planes it merged
+  double largestError{0.0};
+  std::vector<std::uint32_t> offsets;
+  std::vector<std::uint32_t> around;
+  std::vector<Collapse> collapses;
+  std::vector<std::uint32_t> target(vertexCount);
+  std::vector<bool> touched(vertexCount);
+
+  while (result.size() > targetIndexCount) {
+    // Cheapest direction of every edge whose source can move
+    collapses.clear();
+    for (std::size_t corner{0}; corner < result.size(); ++corner) {
+      const auto u{result[corner]};
+      const auto v{result[corner - corner % 3 + (corner + 1) % 3]};
+      auto merged{quadrics[u]};
+      merged += quadrics[v];
+      if (!locked[u]) collapses.push_back({u, v, merged.error(points[v])});
+      if (!locked[v]) collapses.push_back({v, u, merged.error(points[u])});
+    }
+    std::sort(collapses.begin(), collapses.end(),
+              [](const Collapse &lhs, const Collapse &rhs) {
+                return lhs.error < rhs.error;
+              });
+
+    buildAdjacency(result, vertexCount, offsets, around);
+    std::iota(target.begin(), target.end(), 0);
+    std::fill(touched.begin(), touched.end(), false);
+
+    // Each collapse removes about two triangles
+    const auto wanted{(result.size() - targetIndexCount) / 6 + 1};
+    std::size_t performed{0};
+    for (const auto &collapse : collapses) {
+      if (collapse.error > maxError || performed == wanted) break;
+      const auto u{collapse.from};
+      const auto v{collapse.to};
+      if (touched[u] || touched[v]) continue;
+
+      // Reject if a triangle around u that survives would flip or degenerate
+      bool flips{false};
+      for (auto i{offsets[u]}; i < offsets[u + 1] && !flips; ++i) {
+        const auto *triangle{&result[around[i] * 3]};
+        if (triangle[0] == v || triangle[1] == v || triangle[2] == v) continue;
+        std::array<Vec3, 3> before{points[triangle[0]], points[triangle[1]],
+                                   points[triangle[2]]};
+        auto after{before};
+        for (std::size_t k{0}; k < 3; ++k) {
+          if (triangle[k] == u) after[k] = points[v];
+        }
+        const auto n0{cross(before[1] - before[0], before[2] - before[0])};
+        const auto n1{cross(after[1] - after[0], after[2] - after[0])};
+        flips = dot(n0, n1) <= 0.0;
+      }
+      if (flips) continue;
+
+      const auto distance{
+          std::max(largestDistance(u, points[v]), largestDistance(v, points[v]))};
+      if (distance > limit) continue;
+
+      // The one-ring of u changes shape, so its vertices wait for the next
+      // pass, where flip checks see the updated mesh
+      for (auto i{offsets[u]}; i < offsets[u + 1]; ++i) {
+        for (std::size_t k{0}; k < 3; ++k) touched[result[around[i] * 3 + k]] = true;
+      }
+      target[u] = v;
+      quadrics[v] += quadrics[u];
+      auto &merged{planesOf[v]};
+      merged.insert(merged.end(), planesOf[u].begin(), planesOf[u].end());
+      std::sort(merged.begin(), merged.end());
+      merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+      planesOf[u].clear();
+      largestError = std::max(largestError, distance);
+      ++performed;
+    }
+    if (performed == 0) break;
+
+    // Apply the collapses and drop the triangles that became degenerate
+    std::size_t write{0};
+    for (std::size_t corner{0}; corner < result.size(); corner += 3) {
+      const auto a{target[result[corner]]};
+      const auto b{target[result[corner + 1]]};
+      const auto c{target[result[corner + 2]]};
+      if (a == b || b == c || c == a) continue;
+      result[write++] = a;
+      result[write++] = b;
+      result[write++] = c;
+    }
+    result.resize(write);
+  }
+
+  if (resultError != nullptr) {
+    *resultError = static_cast<float>(largestError);
+  }
+  return result;
+}
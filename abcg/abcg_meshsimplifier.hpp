@@ -0,0 +1,59 @@
+/**
+ * @file abcg_meshsimplifier.hpp
+ * @brief Declaration of abcg::simplifyMesh.
+ *
+ * Quadric error metric simplification of indexed triangle meshes, for
+ * generating levels of detail.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_MESHSIMPLIFIER_HPP_
+#define ABCG_MESHSIMPLIFIER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace abcg {
+/**
+ * @brief Reduces the number of triangles of a mesh by collapsing edges.
+ *
+ * Each vertex accumulates the area-weighted quadric of the planes of its
+ * triangles (Garland and Heckbert, "Surface Simplification Using Quadric
+ * Error Metrics", 1997). Edges are collapsed onto one of their endpoints in
+ * order of increasing quadric error, in passes of independent collapses,
+ * until the target triangle count or the error limit is reached. The quadric
+ * error is a weighted mean, so each collapse is also measured by the largest
+ * distance from the new vertex position to the original planes merged into
+ * both endpoints. Collapses beyond the limit, or that would flip a triangle,
+ * are rejected.
+ *
+ * Vertices on open edges (edges of a single triangle) never move. A mesh
+ * welded by all its attributes has open edges wherever attributes change,
+ * such as material boundaries, so those outlines are kept exactly.
+ *
+ * No vertex is created: the result indexes the same vertex array, so all
+ * levels of detail of a mesh can share one vertex buffer.
+ *
+ * @param indices Triangle list, three indices per triangle.
+ * @param positions Vertex positions, three floats (x, y, z) per vertex.
+ * @param vertexCount Number of vertices in the vertex array.
+ * @param positionStride Distance between the positions of consecutive
+ * vertices, in bytes.
+ * @param targetIndexCount Number of indices to reduce the mesh to.
+ * @param targetError Largest distance, in position units, from a moved
+ * vertex to the original planes it merged.
+ * @param resultError If not null, receives the largest such distance of the
+ * collapses performed.
+ * @return Triangle list of the simplified mesh.
+ */
+[[nodiscard]] std::vector<std::uint32_t> simplifyMesh(
+    std::span<const std::uint32_t> indices, const float *positions,
+    std::size_t vertexCount, std::size_t positionStride,
+    std::size_t targetIndexCount, float targetError,
+    float *resultError = nullptr);
+}  // namespace abcg
+
+#endif
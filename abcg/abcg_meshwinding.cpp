@@ -0,0 +1,189 @@
+/**
+ * @file abcg_meshwinding.cpp
+ * @brief Definition of abcg::repairWinding.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_meshwinding.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "abcg_vertexwelder.hpp"
+
+namespace {
+using Position = std::array<float, 3>;
+
+// Directed edge of a triangle, between two welded positions
+struct HalfEdge {
+  std::uint64_t key{};  // smaller position << 32 | larger position
+  std::uint32_t triangle{};
+  bool forward{};  // runs from the smaller position to the larger
+};
+
+// Two triangles sharing an edge; same is true if both run it in the same
+// direction, so one of them must be flipped
+struct Link {
+  std::uint32_t first{};
+  std::uint32_t second{};
+  bool same{};
+};
+
+Position positionOf(const float *positions, std::size_t positionStride,
+                    std::uint32_t vertex) {
+  Position p{};
+  std::memcpy(p.data(),
+              reinterpret_cast<const std::byte *>(positions) +
+                  vertex * positionStride,
+              sizeof(p));
+  return p;
+}
+
+// Six times the signed volume of the tetrahedron (origin, a, b, c)
+double signedVolume(const Position &a, const Position &b, const Position &c,
+                    const Position &origin) {
+  const std::array<double, 3> u{a[0] - origin[0], a[1] - origin[1],
+                                a[2] - origin[2]};
+  const std::array<double, 3> v{b[0] - origin[0], b[1] - origin[1],
+                                b[2] - origin[2]};
+  const std::array<double, 3> w{c[0] - origin[0], c[1] - origin[1],
+                                c[2] - origin[2]};
+  return u[0] * (v[1] * w[2] - v[2] * w[1]) +
+         u[1] * (v[2] * w[0] - v[0] * w[2]) +
+         u[2] * (v[0] * w[1] - v[1] * w[0]);
+}
+}  // namespace
+
+abcg::WindingStatistics abcg::repairWinding(std::span<std::uint32_t> indices,
+                                            const float *positions,
+                                            std::size_t vertexCount,
+                                            std::size_t positionStride) {
+  WindingStatistics statistics;
+  const auto triangleCount{indices.size() / 3};
+  if (triangleCount == 0) return statistics;
+
+  // Vertices at the same position are the same point of the surface
+  std::vector<std::uint32_t> positionIds(vertexCount);
+  {
+    VertexWelder<Position> welder{vertexCount};
+    for (std::uint32_t vertex{0}; vertex < vertexCount; ++vertex) {
+      positionIds[vertex] =
+          welder.weld(positionOf(positions, positionStride, vertex));
+    }
+  }
+
+  std::vector<HalfEdge> halfEdges;
+  halfEdges.reserve(triangleCount * 3);
+  for (std::size_t corner{0}; corner < triangleCount * 3; ++corner) {
+    const auto from{positionIds[indices[corner]]};
+    const auto to{positionIds[indices[corner - corner % 3 + (corner + 1) % 3]]};
+    if (from == to) continue;
+    halfEdges.push_back({std::uint64_t{std::min(from, to)} << 32 |
+                             std::max(from, to),
+                         static_cast<std::uint32_t>(corner / 3), from < to});
+  }
+  std::sort(halfEdges.begin(), halfEdges.end(),
+            [](const HalfEdge &lhs, const HalfEdge &rhs) {
+              return lhs.key < rhs.key;
+            });
+
+  std::vector<Link> links;
+  std::vector<bool> open(triangleCount, false);
+  for (std::size_t begin{0}, end{0}; begin < halfEdges.size(); begin = end) {
+    while (end < halfEdges.size() && halfEdges[end].key == halfEdges[begin].key) {
+      ++end;
+    }
+    if (end - begin == 1) {
+      ++statistics.openEdges;
+      open[halfEdges[begin].triangle] = true;
+    } else if (end - begin > 2) {
+      ++statistics.nonManifoldEdges;
+    } else if (halfEdges[begin].triangle != halfEdges[begin + 1].triangle) {
+      links.push_back({halfEdges[begin].triangle, halfEdges[begin + 1].triangle,
+                       halfEdges[begin].forward == halfEdges[begin + 1].forward});
+    }
+  }
+
+  // Links of each triangle, in compressed sparse row layout
+  std::vector<std::uint32_t> offsets(triangleCount + 1, 0);
+  for (const auto &link : links) {
+    ++offsets[link.first + 1];
+    ++offsets[link.second + 1];
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<std::uint32_t> neighbors(offsets.back());
+  std::vector<bool> same(offsets.back());
+  {
+    auto next{offsets};
+    for (const auto &link : links) {
+      same[next[link.first]] = link.same;
+      neighbors[next[link.first]++] = link.second;
+      same[next[link.second]] = link.same;
+      neighbors[next[link.second]++] = link.first;
+    }
+  }
+
+  // Flood fill each surface, deciding the flip of every triangle relative to
+  // the first one, then orient the whole surface
+  std::vector<std::uint8_t> flip(triangleCount, 0);
+  std::vector<bool> visited(triangleCount, false);
+  std::vector<std::uint32_t> surface;
+  for (std::uint32_t seed{0}; seed < triangleCount; ++seed) {
+    if (visited[seed]) continue;
+    ++statistics.surfaces;
+    surface.clear();
+    surface.push_back(seed);
+    visited[seed] = true;
+    for (std::size_t next{0}; next < surface.size(); ++next) {
+      const auto triangle{surface[next]};
+      for (auto i{offsets[triangle]}; i < offsets[triangle + 1]; ++i) {
+        const auto neighbor{neighbors[i]};
+        if (visited[neighbor]) continue;
+        visited[neighbor] = true;
+        flip[neighbor] = flip[triangle] ^ static_cast<std::uint8_t>(same[i]);
+        surface.push_back(neighbor);
+      }
+    }
+
+    bool invert{};
+    if (std::none_of(surface.begin(), surface.end(),
+                     [&](std::uint32_t triangle) { return open[triangle]; })) {
+      ++statistics.closedSurfaces;
+      const auto origin{positionOf(positions, positionStride, indices[seed * 3])};
+      double volume{0.0};
+      for (const auto triangle : surface) {
+        const auto *corners{&indices[triangle * 3]};
+        const auto sixVolumes{signedVolume(
+            positionOf(positions, positionStride, corners[0]),
+            positionOf(positions, positionStride, corners[1]),
+            positionOf(positions, positionStride, corners[2]), origin)};
+        volume += flip[triangle] != 0 ? -sixVolumes : sixVolumes;
+      }
+      invert = volume < 0.0;
+    } else {
+      const auto flipped{std::count_if(
+          surface.begin(), surface.end(),
+          [&](std::uint32_t triangle) { return flip[triangle] != 0; })};
+      invert = static_cast<std::size_t>(flipped) * 2 > surface.size();
+    }
+    if (invert) {
+      for (const auto triangle : surface) flip[triangle] ^= 1;
+    }
+  }
+
+  for (std::size_t triangle{0}; triangle < triangleCount; ++triangle) {
+    if (flip[triangle] == 0) continue;
+    std::swap(indices[triangle * 3 + 1], indices[triangle * 3 + 2]);
+    ++statistics.flippedTriangles;
+  }
+  for (const auto &link : links) {
+    if ((flip[link.first] ^ flip[link.second]) != static_cast<std::uint8_t>(link.same)) {
+      ++statistics.inconsistentEdges;
+    }
+  }
+  return statistics;
+}
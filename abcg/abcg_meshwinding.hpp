@@ -0,0 +1,73 @@
+/**
+ * @file abcg_meshwinding.hpp
+ * @brief Declaration of abcg::repairWinding.
+ *
+ * Validation and repair of the triangle winding of indexed meshes, so that
+ * back faces can be culled.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_MESHWINDING_HPP_
+#define ABCG_MESHWINDING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace abcg {
+struct WindingStatistics;
+
+/**
+ * @brief Makes the winding of neighboring triangles consistent and turns
+ * closed surfaces outward.
+ *
+ * Triangles are connected through the edges they share by position, not by
+ * index, so vertices split by other attributes (such as a material boundary)
+ * do not split the surface. Each connected surface is traversed from one
+ * triangle and its neighbors are flipped wherever they run a shared edge in
+ * the same direction. Edges shared by more than two triangles do not connect
+ * them.
+ *
+ * A surface with no open edges is then turned so that its signed volume is
+ * positive: counterclockwise triangles, seen from outside, in a right-handed
+ * frame. An open surface keeps the orientation of most of its triangles.
+ *
+ * A triangle is flipped by swapping its last two indices; positions and
+ * triangle order are unchanged.
+ *
+ * @param indices Triangle list, rewritten in place.
+ * @param positions Vertex positions, three floats (x, y, z) per vertex.
+ * @param vertexCount Number of vertices in the vertex array.
+ * @param positionStride Distance between the positions of consecutive
+ * vertices, in bytes.
+ * @return What was found and changed.
+ */
+WindingStatistics repairWinding(std::span<std::uint32_t> indices,
+                                const float *positions,
+                                std::size_t vertexCount,
+                                std::size_t positionStride);
+}  // namespace abcg
+
+/**
+ * @brief Result of abcg::repairWinding.
+ *
+ */
+struct abcg::WindingStatistics {
+  /** @brief Number of connected surfaces. */
+  std::size_t surfaces{};
+  /** @brief Number of surfaces with no open edge. */
+  std::size_t closedSurfaces{};
+  /** @brief Number of triangles whose winding was reversed. */
+  std::size_t flippedTriangles{};
+  /** @brief Number of edges used by a single triangle. */
+  std::size_t openEdges{};
+  /** @brief Number of edges used by more than two triangles. */
+  std::size_t nonManifoldEdges{};
+  /** @brief Number of shared edges still run in the same direction by both
+   * triangles after the repair (nonzero only for non-orientable surfaces,
+   * such as a Möbius strip). */
+  std::size_t inconsistentEdges{};
+};
+
+#endif
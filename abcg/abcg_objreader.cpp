@@ -0,0 +1,320 @@
+/**
+ * @file abcg_objreader.cpp
+ * @brief Definition of abcg::readObj.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_objreader.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+
+#include "abcg_exception.hpp"
+#include "abcg_meshcache.hpp"
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define ABCG_OBJREADER_SINGLE_THREAD 1
+#endif
+
+namespace {
+// Line-aligned slice of the file and what the passes learn about it
+struct Chunk {
+  std::string_view text;
+
+  // First pass
+  std::size_t vertexCount{};
+  std::size_t triangleCount{};
+  std::string_view lastMaterial;  // Name in the last usemtl, if any
+  std::string_view materialLibrary;  // First file name in mtllib, if any
+
+  // Prefix sums of the first pass
+  std::size_t firstVertex{};
+  std::size_t firstTriangle{};
+  std::int32_t initialMaterial{-1};
+
+  // Second pass
+  bool invalidIndex{};
+};
+
+constexpr bool isBlank(char c) noexcept { return c == ' ' || c == '\t'; }
+
+std::string_view trimmed(std::string_view text) noexcept {
+  while (!text.empty() && (isBlank(text.front()))) text.remove_prefix(1);
+  while (!text.empty() && (isBlank(text.back()) || text.back() == '\r')) {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+// Calls function(line) for each line, without leading blanks or trailing CR
+template <typename F>
+void forEachLine(std::string_view text, F &&function) {
+  while (!text.empty()) {
+    const auto end{text.find('\n')};
+    auto line{text.substr(0, end)};
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+
+    while (!line.empty() && isBlank(line.front())) line.remove_prefix(1);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    if (!line.empty()) function(line);
+  }
+}
+
+// Returns the arguments of the statement if line is `keyword args`
+bool statement(std::string_view line, std::string_view keyword,
+               std::string_view &arguments) noexcept {
+  if (line.size() <= keyword.size() || !line.starts_with(keyword) ||
+      !isBlank(line[keyword.size()])) {
+    return false;
+  }
+  arguments = line.substr(keyword.size() + 1);
+  return true;
+}
+
+std::size_t countTokens(std::string_view text) noexcept {
+  std::size_t count{0};
+  bool inToken{false};
+  for (const auto c : text) {
+    const bool blank{isBlank(c) || c == '\r'};
+    if (!blank && !inToken) ++count;
+    inToken = !blank;
+  }
+  return count;
+}
+
+const char *skipBlanks(const char *first, const char *last) noexcept {
+  while (first != last && isBlank(*first)) ++first;
+  return first;
+}
+
+const char *skipToken(const char *first, const char *last) noexcept {
+  while (first != last && !isBlank(*first) && *first != '\r') ++first;
+  return first;
+}
+
+// Parses a float at first, or leaves value unchanged if there is none
+const char *parseFloat(const char *first, const char *last, float &value) {
+  first = skipBlanks(first, last);
+  if (first != last && *first == '+') ++first;
+#if defined(__cpp_lib_to_chars)
+  const auto result{std::from_chars(first, last, value)};
+  return result.ec == std::errc{} ? result.ptr : skipToken(first, last);
+#else
+  // Floating-point std::from_chars is not available in this standard library
+  const auto *end{skipToken(first, last)};
+  std::array<char, 64> buffer{};
+  const auto length{std::min<std::size_t>(end - first, buffer.size() - 1)};
+  std::copy_n(first, length, buffer.data());
+  char *parsed{};
+  const auto result{std::strtof(buffer.data(), &parsed)};
+  if (parsed != buffer.data()) value = result;
+  return end;
+#endif
+}
+
+void countChunk(Chunk &chunk) {
+  forEachLine(chunk.text, [&chunk](std::string_view line) {
+    std::string_view arguments;
+    if (statement(line, "v", arguments)) {
+      ++chunk.vertexCount;
+    } else if (statement(line, "f", arguments)) {
+      const auto corners{countTokens(arguments)};
+      if (corners >= 3) chunk.triangleCount += corners - 2;
+    } else if (statement(line, "usemtl", arguments)) {
+      chunk.lastMaterial = trimmed(arguments);
+    } else if (statement(line, "mtllib", arguments) &&
+               chunk.materialLibrary.empty()) {
+      arguments = trimmed(arguments);
+      chunk.materialLibrary =
+          arguments.substr(0, arguments.find_first_of(" \t"));
+    }
+  });
+}
+
+void parseChunk(
+    Chunk &chunk, std::size_t totalVertices,
+    const std::unordered_map<std::string, std::int32_t> &materialIds,
+    abcg::ObjMesh &mesh) {
+  auto vertex{chunk.firstVertex};
+  auto triangle{chunk.firstTriangle};
+  auto material{chunk.initialMaterial};
+
+  forEachLine(chunk.text, [&](std::string_view line) {
+    std::string_view arguments;
+    if (statement(line, "v", arguments)) {
+      const auto *first{arguments.data()};
+      const auto *last{first + arguments.size()};
+      auto *position{&mesh.positions[vertex * 3]};
+      first = parseFloat(first, last, position[0]);
+      first = parseFloat(first, last, position[1]);
+      parseFloat(first, last, position[2]);
+      ++vertex;
+    } else if (statement(line, "f", arguments)) {
+      const auto *first{arguments.data()};
+      const auto *last{first + arguments.size()};
+      std::uint32_t corners[2]{};
+      std::size_t corner{0};
+      while ((first = skipBlanks(first, last)) != last && *first != '\r') {
+        long index{};
+        const auto result{std::from_chars(first, last, index)};
+        first = skipToken(result.ptr, last);
+
+        // Positive indices count from 1, negative ones back from the
+        // vertices read so far
+        const auto resolved{index > 0 ? index - 1
+                                      : static_cast<long>(vertex) + index};
+        if (result.ec != std::errc{} || index == 0 || resolved < 0 ||
+            static_cast<std::size_t>(resolved) >= totalVertices) {
+          chunk.invalidIndex = true;
+          return;
+        }
+
+        // Fan triangulation: (first, previous, current)
+        const auto current{static_cast<std::uint32_t>(resolved)};
+        if (corner >= 2) {
+          auto *indices{&mesh.indices[triangle * 3]};
+          indices[0] = corners[0];
+          indices[1] = corners[1];
+          indices[2] = current;
+          mesh.materialIds[triangle] = material;
+          ++triangle;
+        }
+        corners[corner == 0 ? 0 : 1] = current;
+        ++corner;
+      }
+    } else if (statement(line, "usemtl", arguments)) {
+      const auto found{materialIds.find(std::string{trimmed(arguments)})};
+      material = found == materialIds.end() ? -1 : found->second;
+    }
+  });
+}
+
+std::vector<std::string> readMaterialNames(const std::filesystem::path &path) {
+  std::vector<std::string> names;
+  const abcg::MappedFile file{path.string()};
+  if (!file.isOpen()) {
+    fmt::print("Warning: material file {} not found\n", path.string());
+    return names;
+  }
+  const auto bytes{file.bytes()};
+  forEachLine({reinterpret_cast<const char *>(bytes.data()), bytes.size()},
+              [&names](std::string_view line) {
+                std::string_view arguments;
+                if (statement(line, "newmtl", arguments)) {
+                  names.emplace_back(trimmed(arguments));
+                }
+              });
+  return names;
+}
+
+// Runs function(i) for i in [0, count) on the given number of threads
+template <typename F>
+void parallelFor(std::size_t count, unsigned threads, F &&function) {
+  std::atomic<std::size_t> next{0};
+  auto worker{[&] {
+    for (auto i{next++}; i < count; i = next++) function(i);
+  }};
+#if !defined(ABCG_OBJREADER_SINGLE_THREAD)
+  std::vector<std::thread> pool;
+  for (unsigned thread{1}; thread < std::min<std::size_t>(threads, count);
+       ++thread) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : pool) thread.join();
+#else
+  (void)threads;
+  worker();
+#endif
+}
+}  // namespace
+
+abcg::ObjMesh abcg::readObj(std::string_view path, unsigned threads) {
+  const MappedFile file{path};
+  if (!file.isOpen()) {
+    throw abcg::Exception{
+        abcg::Exception::Runtime(fmt::format("Failed to load model {}", path))};
+  }
+  const std::string_view text{reinterpret_cast<const char *>(file.bytes().data()),
+                              file.bytes().size()};
+
+#if defined(ABCG_OBJREADER_SINGLE_THREAD)
+  threads = 1;
+#endif
+  if (threads == 0) threads = std::max(1U, std::thread::hardware_concurrency());
+
+  // A few chunks per thread balance uneven lines; small files are not split
+  constexpr std::size_t minimumChunkSize{256 * 1024};
+  const auto chunkCount{std::clamp<std::size_t>(text.size() / minimumChunkSize,
+                                                1, threads * 4)};
+  std::vector<Chunk> chunks(chunkCount);
+  std::size_t begin{0};
+  for (std::size_t i{0}; i < chunkCount; ++i) {
+    auto end{i + 1 == chunkCount ? text.size()
+                                 : text.size() * (i + 1) / chunkCount};
+    end = std::max(end, begin);
+    if (end < text.size()) {
+      const auto newline{text.find('\n', end)};
+      end = newline == std::string_view::npos ? text.size() : newline + 1;
+    }
+    chunks[i].text = text.substr(begin, end - begin);
+    begin = end;
+  }
+
+  parallelFor(chunkCount, threads, [&chunks](std::size_t i) { countChunk(chunks[i]); });
+
+  // Materials, and where each chunk starts in the output arrays
+  ObjMesh mesh;
+  const auto library{std::find_if(chunks.begin(), chunks.end(), [](const Chunk &chunk) {
+    return !chunk.materialLibrary.empty();
+  })};
+  if (library != chunks.end()) {
+    mesh.materialNames = readMaterialNames(
+        std::filesystem::path{path}.parent_path() / library->materialLibrary);
+  }
+  std::unordered_map<std::string, std::int32_t> materialIds;
+  for (std::size_t id{0}; id < mesh.materialNames.size(); ++id) {
+    materialIds.try_emplace(mesh.materialNames[id], static_cast<std::int32_t>(id));
+  }
+
+  std::size_t vertexCount{0};
+  std::size_t triangleCount{0};
+  std::int32_t material{-1};
+  for (auto &chunk : chunks) {
+    chunk.firstVertex = vertexCount;
+    chunk.firstTriangle = triangleCount;
+    chunk.initialMaterial = material;
+    vertexCount += chunk.vertexCount;
+    triangleCount += chunk.triangleCount;
+    if (!chunk.lastMaterial.empty()) {
+      const auto found{materialIds.find(std::string{chunk.lastMaterial})};
+      material = found == materialIds.end() ? -1 : found->second;
+    }
+  }
+
+  mesh.positions.resize(vertexCount * 3);
+  mesh.indices.resize(triangleCount * 3);
+  mesh.materialIds.resize(triangleCount);
+
+  parallelFor(chunkCount, threads, [&](std::size_t i) {
+    parseChunk(chunks[i], vertexCount, materialIds, mesh);
+  });
+
+  if (std::any_of(chunks.begin(), chunks.end(),
+                  [](const Chunk &chunk) { return chunk.invalidIndex; })) {
+    throw abcg::Exception{abcg::Exception::Runtime(
+        fmt::format("Failed to load model {} (invalid face index)", path))};
+  }
+
+  return mesh;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file abcg_objreader.hpp
+ * @brief abcg::ObjMesh and abcg::readObj header file.
+ *
+ * Multithreaded reader of the geometry of Wavefront OBJ files.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OBJREADER_HPP_
+#define ABCG_OBJREADER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace abcg {
+struct ObjMesh;
+
+/**
+ * @brief Reads the positions, triangles and material ids of an OBJ file.
+ *
+ * The file is memory-mapped and split into line-aligned chunks. A first
+ * parallel pass counts the vertices and triangles of each chunk, so that a
+ * second parallel pass can parse every chunk with std::from_chars straight
+ * into its final place in the output arrays, with no intermediate copies.
+ *
+ * Supported statements: `v` (extra components are ignored), `f` with
+ * `v`, `v/vt`, `v//vn` or `v/vt/vn` corners and positive or negative
+ * (relative) indices, `mtllib` and `usemtl`. Other statements are ignored.
+ * Polygons are triangulated as fans, which matches tinyobjloader for convex
+ * polygons.
+ *
+ * Material ids follow tinyobjloader: the index of the `newmtl` statement in
+ * the first file named by `mtllib` (looked up in the directory of the OBJ
+ * file), or -1 for faces without `usemtl` or with an unknown material.
+ *
+ * @param path Path to the OBJ file.
+ * @param threads Number of threads. 0 uses one thread per hardware thread.
+ * @return Mesh read from the file.
+ *
+ * @throw abcg::Exception if the file cannot be read or has a face index out
+ * of range.
+ */
+[[nodiscard]] ObjMesh readObj(std::string_view path, unsigned threads = 0);
+}  // namespace abcg
+
+/**
+ * @brief Geometry read by abcg::readObj.
+ *
+ */
+struct abcg::ObjMesh {
+  /** @brief Vertex positions, three floats (x, y, z) per vertex. */
+  std::vector<float> positions;
+  /** @brief Position indices, three per triangle. */
+  std::vector<std::uint32_t> indices;
+  /** @brief Material id of each triangle (-1 if none). */
+  std::vector<std::int32_t> materialIds;
+  /** @brief Material names, indexed by material id. */
+  std::vector<std::string> materialNames;
+};
+
+#endif
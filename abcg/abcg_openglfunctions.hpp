@@ -1227,6 +1227,18 @@ inline void glGetInternalformativ(GLenum target, GLenum internalformat,
          count, params);
 }
 
+#if !defined(__EMSCRIPTEN__)
+
+// OpenGL 4.4+ function definitions (or ARB_buffer_storage)
+
+inline void glBufferStorage(GLenum target, GLsizeiptr size, const void* data,
+                            GLbitfield flags,
+                            const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glBufferStorage, target, size, data, flags);
+}
+
+#endif
+
 #if !defined(NDEBUG) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
 
 // OpenGL 3.0+ function definitions
@@ -0,0 +1,90 @@
+/**
+ * @file abcg_programreflection.cpp
+ * @brief Definition of abcg::ProgramReflection class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_programreflection.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "abcg_exception.hpp"
+
+namespace {
+// Array uniforms are reported as "name[0]"; make them reachable as "name"
+std::string baseName(std::string name) {
+  if (name.ends_with("[0]")) name.resize(name.size() - 3);
+  return name;
+}
+}  // namespace
+
+abcg::ProgramReflection::ProgramReflection(GLuint program)
+    : m_program{program} {
+  GLint maxLength{};
+  std::vector<GLchar> name;
+
+  GLint activeUniforms{};
+  abcg::glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &activeUniforms);
+  abcg::glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+  name.resize(static_cast<std::size_t>(std::max(maxLength, 1)));
+  for (GLint index{}; index < activeUniforms; ++index) {
+    GLsizei length{};
+    ActiveVariable variable{};
+    abcg::glGetActiveUniform(program, static_cast<GLuint>(index),
+                             static_cast<GLsizei>(name.size()), &length,
+                             &variable.size, &variable.type, name.data());
+    // Uniforms inside blocks have no location and are skipped
+    variable.location = abcg::glGetUniformLocation(program, name.data());
+    if (variable.location < 0) continue;
+    m_uniforms.emplace(baseName({name.data(), static_cast<std::size_t>(length)}),
+                       variable);
+  }
+
+  GLint activeAttributes{};
+  abcg::glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &activeAttributes);
+  abcg::glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+  name.resize(static_cast<std::size_t>(std::max(maxLength, 1)));
+  for (GLint index{}; index < activeAttributes; ++index) {
+    GLsizei length{};
+    ActiveVariable variable{};
+    abcg::glGetActiveAttrib(program, static_cast<GLuint>(index),
+                            static_cast<GLsizei>(name.size()), &length,
+                            &variable.size, &variable.type, name.data());
+    // Built-ins such as gl_VertexID are reported with location -1
+    variable.location = abcg::glGetAttribLocation(program, name.data());
+    if (variable.location < 0) continue;
+    m_attributes.emplace(
+        baseName({name.data(), static_cast<std::size_t>(length)}), variable);
+  }
+}
+
+abcg::ActiveVariable abcg::ProgramReflection::getUniform(
+    std::string_view name) const {
+  if (const auto it{m_uniforms.find(std::string{name})};
+      it != m_uniforms.end()) {
+    return it->second;
+  }
+  return {};
+}
+
+abcg::ActiveVariable abcg::ProgramReflection::getAttribute(
+    std::string_view name) const {
+  if (const auto it{m_attributes.find(std::string{name})};
+      it != m_attributes.end()) {
+    return it->second;
+  }
+  return {};
+}
+
+void abcg::ProgramReflection::checkType(std::string_view name, GLenum actual,
+                                        GLenum expected) {
+  if (actual != expected) {
+    throw abcg::Exception{abcg::Exception::Runtime(fmt::format(
+        "Uniform {} has GL type {:#x}, expected {:#x}", name, actual,
+        expected))};
+  }
+}
@@ -0,0 +1,172 @@
+/**
+ * @file abcg_programreflection.hpp
+ * @brief abcg::ProgramReflection header file.
+ *
+ * Declaration of abcg::ProgramReflection and of the typed handles it hands
+ * out for uniform variables and vertex attributes.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_PROGRAMREFLECTION_HPP_
+#define ABCG_PROGRAMREFLECTION_HPP_
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+#include "abcg_openglfunctions.hpp"
+
+namespace abcg {
+struct ActiveVariable;
+class ProgramReflection;
+template <typename T>
+class Uniform;
+
+/**
+ * @brief OpenGL type enumerant of the GLSL type that matches a C++ type.
+ *
+ * @tparam T C++ type (GLfloat, GLint, GLuint, glm vectors or matrices).
+ * @return GLenum such as GL_FLOAT_VEC3 or GL_FLOAT_MAT4.
+ */
+template <typename T>
+[[nodiscard]] constexpr GLenum glTypeOf() noexcept {
+  if constexpr (std::is_same_v<T, GLfloat>) return GL_FLOAT;
+  if constexpr (std::is_same_v<T, GLint>) return GL_INT;
+  if constexpr (std::is_same_v<T, GLuint>) return GL_UNSIGNED_INT;
+  if constexpr (std::is_same_v<T, glm::vec2>) return GL_FLOAT_VEC2;
+  if constexpr (std::is_same_v<T, glm::vec3>) return GL_FLOAT_VEC3;
+  if constexpr (std::is_same_v<T, glm::vec4>) return GL_FLOAT_VEC4;
+  if constexpr (std::is_same_v<T, glm::mat3>) return GL_FLOAT_MAT3;
+  if constexpr (std::is_same_v<T, glm::mat4>) return GL_FLOAT_MAT4;
+  return GL_NONE;
+}
+}  // namespace abcg
+
+/**
+ * @brief Description of an active uniform variable or vertex attribute.
+ *
+ */
+struct abcg::ActiveVariable {
+  GLint location{-1};
+  GLenum type{GL_NONE};
+  GLint size{};
+};
+
+/**
+ * @brief Typed handle to a uniform variable of a linked program.
+ *
+ * Holds only the location resolved by abcg::ProgramReflection, so setting
+ * the value never goes through a name lookup. A default-constructed handle,
+ * or one for a uniform the linker optimized away, has location -1 and
+ * setting it is a no-op, as with glUniform*.
+ *
+ * @tparam T C++ type of the uniform (see abcg::glTypeOf).
+ */
+template <typename T>
+class abcg::Uniform {
+ public:
+  Uniform() = default;
+
+  [[nodiscard]] GLint location() const noexcept { return m_location; }
+  [[nodiscard]] bool isActive() const noexcept { return m_location >= 0; }
+
+  /**
+   * @brief Sets the uniform value on the program currently in use.
+   *
+   * @param value Value to be set.
+   */
+  void set(const T& value) const {
+    if constexpr (std::is_same_v<T, GLfloat>) {
+      abcg::glUniform1f(m_location, value);
+    } else if constexpr (std::is_same_v<T, GLint>) {
+      abcg::glUniform1i(m_location, value);
+    } else if constexpr (std::is_same_v<T, GLuint>) {
+      abcg::glUniform1ui(m_location, value);
+    } else if constexpr (std::is_same_v<T, glm::vec2>) {
+      abcg::glUniform2fv(m_location, 1, &value.x);
+    } else if constexpr (std::is_same_v<T, glm::vec3>) {
+      abcg::glUniform3fv(m_location, 1, &value.x);
+    } else if constexpr (std::is_same_v<T, glm::vec4>) {
+      abcg::glUniform4fv(m_location, 1, &value.x);
+    } else if constexpr (std::is_same_v<T, glm::mat3>) {
+      abcg::glUniformMatrix3fv(m_location, 1, GL_FALSE, &value[0][0]);
+    } else {
+      static_assert(std::is_same_v<T, glm::mat4>, "Unsupported uniform type");
+      abcg::glUniformMatrix4fv(m_location, 1, GL_FALSE, &value[0][0]);
+    }
+  }
+
+ private:
+  friend ProgramReflection;
+  explicit Uniform(GLint location) noexcept : m_location{location} {}
+
+  GLint m_location{-1};
+};
+
+/**
+ * @brief abcg::ProgramReflection class.
+ *
+ * Enumerates the active uniforms and vertex attributes of a program object
+ * right after it has been linked (e.g., the value returned by
+ * abcg::OpenGLWindow::createProgramFromString), so that locations are
+ * queried from the driver once instead of by name every frame.
+ */
+class abcg::ProgramReflection {
+ public:
+  ProgramReflection() = default;
+  explicit ProgramReflection(GLuint program);
+
+  [[nodiscard]] GLuint getProgram() const noexcept { return m_program; }
+
+  [[nodiscard]] ActiveVariable getUniform(std::string_view name) const;
+  [[nodiscard]] ActiveVariable getAttribute(std::string_view name) const;
+
+  /**
+   * @brief Returns a typed handle to a uniform variable.
+   *
+   * @tparam T C++ type of the uniform.
+   * @param name Name of the uniform in the shader source.
+   * @return Handle to the uniform. If the uniform is not active, the handle
+   * has location -1.
+   * @throw abcg::Exception if the uniform is active but its GLSL type does
+   * not match T.
+   */
+  template <typename T>
+  [[nodiscard]] Uniform<T> uniform(std::string_view name) const {
+    const auto variable{getUniform(name)};
+    if (variable.location >= 0) checkType(name, variable.type, glTypeOf<T>());
+    return Uniform<T>{variable.location};
+  }
+
+  /**
+   * @brief Returns the location of a vertex attribute.
+   *
+   * @param name Name of the attribute in the vertex shader.
+   * @return Location of the attribute, or -1 if it is not active. For matrix
+   * attributes, this is the location of the first column.
+   */
+  [[nodiscard]] GLint attributeLocation(std::string_view name) const {
+    return getAttribute(name).location;
+  }
+
+  [[nodiscard]] const auto& getUniforms() const noexcept { return m_uniforms; }
+  [[nodiscard]] const auto& getAttributes() const noexcept {
+    return m_attributes;
+  }
+
+ private:
+  static void checkType(std::string_view name, GLenum actual, GLenum expected);
+
+  GLuint m_program{};
+  std::unordered_map<std::string, ActiveVariable> m_uniforms;
+  std::unordered_map<std::string, ActiveVariable> m_attributes;
+};
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ * @file abcg_ringbuffer.cpp
+ * @brief Definition of abcg::RingBuffer members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_ringbuffer.hpp"
+
+#include "abcg_exception.hpp"
+
+void abcg::RingBuffer::create(GLsizeiptr regionSize, std::size_t regionCount) {
+  destroy();
+  m_regionSize = regionSize;
+  m_fences.assign(regionCount, nullptr);
+  // The first call to map() moves to region 0
+  m_region = regionCount - 1;
+
+  const auto size{regionSize * static_cast<GLsizeiptr>(regionCount)};
+  abcg::glGenBuffers(1, &m_buffer);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+#if !defined(__EMSCRIPTEN__)
+  if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage) {
+    // Immutable storage, mapped once for the lifetime of the buffer. Coherent
+    // writes are visible to the GPU without explicit flushes
+    constexpr GLbitfield flags{GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                               GL_MAP_COHERENT_BIT};
+    abcg::glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+    m_persistent = static_cast<std::byte *>(
+        abcg::glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+    if (m_persistent == nullptr) {
+      abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+      destroy();
+      throw abcg::Exception{
+          abcg::Exception::Runtime("Failed to map ring buffer")};
+    }
+  } else
+#endif
+  {
+    abcg::glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+  }
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+#if defined(__EMSCRIPTEN__)
+  m_staging.resize(static_cast<std::size_t>(regionSize));
+#endif
+}
+
+void abcg::RingBuffer::destroy() {
+  for (auto &fence : m_fences) {
+    if (fence != nullptr) abcg::glDeleteSync(fence);
+  }
+  m_fences.clear();
+  // Deleting the buffer also releases its persistent mapping
+  abcg::glDeleteBuffers(1, &m_buffer);
+  m_buffer = 0;
+  m_persistent = nullptr;
+  m_regionSize = 0;
+}
+
+std::byte *abcg::RingBuffer::map(bool discard) {
+  m_region = (m_region + 1) % m_fences.size();
+  waitForRegion();
+
+  const auto offset{m_regionSize * static_cast<GLsizeiptr>(m_region)};
+  if (m_persistent != nullptr) return m_persistent + offset;
+
+#if defined(__EMSCRIPTEN__)
+  (void)discard;
+  m_flushed.clear();
+  return m_staging.data();
+#else
+  // The fence already guarantees that the GPU is done with the region
+  GLbitfield access{GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                    GL_MAP_FLUSH_EXPLICIT_BIT};
+  if (discard) access |= GL_MAP_INVALIDATE_RANGE_BIT;
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+  auto *region{static_cast<std::byte *>(abcg::glMapBufferRange(
+      GL_ARRAY_BUFFER, offset, m_regionSize, access))};
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+  if (region == nullptr) {
+    throw abcg::Exception{
+        abcg::Exception::Runtime("Failed to map ring buffer region")};
+  }
+  return region;
+#endif
+}
+
+void abcg::RingBuffer::flush(GLintptr offset, GLsizeiptr size) {
+  if (m_persistent != nullptr || size == 0) return;
+#if defined(__EMSCRIPTEN__)
+  m_flushed.emplace_back(offset, size);
+#else
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+  abcg::glFlushMappedBufferRange(GL_ARRAY_BUFFER, offset, size);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+}
+
+bool abcg::RingBuffer::unmap() {
+  if (m_persistent != nullptr) return true;
+
+  bool valid{true};
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+#if defined(__EMSCRIPTEN__)
+  const auto offset{regionOffset()};
+  for (const auto &[rangeOffset, size] : m_flushed) {
+    abcg::glBufferSubData(GL_ARRAY_BUFFER, offset + rangeOffset, size,
+                          m_staging.data() + rangeOffset);
+  }
+#else
+  // GL_FALSE means the data store was corrupted while mapped (on a display
+  // mode change, for instance)
+  valid = abcg::glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+#endif
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return valid;
+}
+
+void abcg::RingBuffer::fence() {
+#if !defined(__EMSCRIPTEN__)
+  auto &fence{m_fences[m_region]};
+  if (fence != nullptr) abcg::glDeleteSync(fence);
+  fence = abcg::glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+}
+
+// WebGL 2.0 does not allow waiting on fences, and glBufferSubData is already
+// synchronized by the browser, so Emscripten builds never create them
+void abcg::RingBuffer::waitForRegion() {
+  auto &fence{m_fences[m_region]};
+  if (fence == nullptr) return;
+
+  // The first wait flushes the commands that signal the fence, so that it
+  // cannot wait forever
+  constexpr GLuint64 timeout{1'000'000};  // 1 ms, in nanoseconds
+  GLbitfield flags{GL_SYNC_FLUSH_COMMANDS_BIT};
+  while (true) {
+    const auto status{abcg::glClientWaitSync(fence, flags, timeout)};
+    if (status != GL_TIMEOUT_EXPIRED) break;
+    flags = 0;
+  }
+  abcg::glDeleteSync(fence);
+  fence = nullptr;
+}
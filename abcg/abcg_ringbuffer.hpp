@@ -0,0 +1,140 @@
+/**
+ * @file abcg_ringbuffer.hpp
+ * @brief abcg::RingBuffer header file.
+ *
+ * Vertex buffer split into regions that are written by the CPU in turns, so
+ * that per-frame data can be streamed while the GPU still reads the data of
+ * previous frames.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_RINGBUFFER_HPP_
+#define ABCG_RINGBUFFER_HPP_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "abcg_openglfunctions.hpp"
+
+namespace abcg {
+class RingBuffer;
+}  // namespace abcg
+
+/**
+ * @brief GL_ARRAY_BUFFER with a ring of equally sized regions, each guarded
+ * by a fence.
+ *
+ * Each frame maps the next region, writes it, unmaps it, issues the draw
+ * calls that read it and then calls fence(). Mapping a region waits only for
+ * the fence of the frame that last used it, which with three regions has
+ * usually signaled long before, so the driver never has to stall or copy.
+ *
+ * Where the context supports ARB_buffer_storage (OpenGL 4.4), the whole
+ * buffer is mapped once with a persistent, coherent mapping, and map() just
+ * returns a pointer into it. Otherwise each region is mapped with
+ * glMapBufferRange, unsynchronized and with explicit flushes. WebGL 2.0 has
+ * neither, so in Emscripten builds writes go to a CPU-side copy of the region
+ * and the flushed ranges are sent with glBufferSubData when it is unmapped.
+ *
+ * Buffer, fences and mapping must be released by destroy() while the OpenGL
+ * context is current.
+ */
+class abcg::RingBuffer {
+ public:
+  RingBuffer() = default;
+  RingBuffer(const RingBuffer &) = delete;
+  RingBuffer &operator=(const RingBuffer &) = delete;
+
+  /**
+   * @brief Creates the buffer, replacing the current one.
+   *
+   * @param regionSize Size of each region, in bytes.
+   * @param regionCount Number of regions: the number of frames that can be in
+   * flight before map() waits for the GPU.
+   * @throw abcg::Exception if the persistent mapping fails.
+   */
+  void create(GLsizeiptr regionSize, std::size_t regionCount = 3);
+
+  /**
+   * @brief Deletes the buffer and its fences.
+   */
+  void destroy();
+
+  /**
+   * @brief Makes the next region current and maps it for writing, waiting
+   * for the GPU to finish reading it first.
+   *
+   * @param discard Whether the previous contents of the region may be
+   * discarded. Pass true only if the whole region will be rewritten.
+   * @return Pointer to the first byte of the region. Only written ranges
+   * passed to flush() are guaranteed to reach the buffer.
+   * @throw abcg::Exception if the region cannot be mapped.
+   */
+  [[nodiscard]] std::byte *map(bool discard);
+
+  /**
+   * @brief Marks a range of the mapped region as written.
+   *
+   * @param offset Offset of the range from the start of the region, in bytes.
+   * @param size Size of the range, in bytes.
+   */
+  void flush(GLintptr offset, GLsizeiptr size);
+
+  /**
+   * @brief Ends writing to the current region.
+   *
+   * @return false if the driver reports that the contents of the buffer
+   * were lost while mapped (glUnmapBuffer returned GL_FALSE). The region is
+   * then undefined and must be written in full the next time it is mapped.
+   */
+  [[nodiscard]] bool unmap();
+
+  /**
+   * @brief Returns the offset of the current region from the start of the
+   * buffer, in bytes, to be added to the vertex attribute offsets of the draw
+   * calls that read it.
+   */
+  [[nodiscard]] GLintptr regionOffset() const noexcept {
+    return m_regionSize * static_cast<GLintptr>(m_region);
+  }
+
+  /**
+   * @brief Inserts the fence of the current region into the command stream.
+   * Call after the last draw call that reads the region.
+   */
+  void fence();
+
+  /**
+   * @brief Returns the buffer object, or 0 if not created.
+   */
+  [[nodiscard]] GLuint buffer() const noexcept { return m_buffer; }
+
+  /**
+   * @brief Returns the size of each region, in bytes.
+   */
+  [[nodiscard]] GLsizeiptr regionSize() const noexcept { return m_regionSize; }
+
+  /**
+   * @brief Returns whether the buffer is persistently mapped.
+   */
+  [[nodiscard]] bool isPersistent() const noexcept {
+    return m_persistent != nullptr;
+  }
+
+ private:
+  GLuint m_buffer{};
+  GLsizeiptr m_regionSize{};
+  std::size_t m_region{};
+  std::vector<GLsync> m_fences;
+  std::byte *m_persistent{};
+#if defined(__EMSCRIPTEN__)
+  std::vector<std::byte> m_staging;
+  std::vector<std::pair<GLintptr, GLsizeiptr>> m_flushed;
+#endif
+
+  void waitForRegion();
+};
+
+#endif
@@ -0,0 +1,198 @@
+/**
+ * @file abcg_vertexwelder.hpp
+ * @brief abcg::VertexWelder header file.
+ *
+ * Declaration and definition of abcg::VertexWelder, an open-addressing hash
+ * table that merges identical vertices into an indexed vertex array.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_VERTEXWELDER_HPP_
+#define ABCG_VERTEXWELDER_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define ABCG_VERTEXWELDER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace abcg {
+template <typename T>
+class VertexWelder;
+}  // namespace abcg
+
+/**
+ * @brief Merges identical vertices, assigning each distinct vertex an index.
+ *
+ * Vertices are compared by their whole object representation (every byte
+ * of every attribute), so two vertices are merged only if all attributes
+ * match. T must therefore have no padding bytes.
+ *
+ * The table is a flat array of slots grouped by 16, with one control byte
+ * per slot holding 7 bits of the hash, as in SwissTable. A lookup compares
+ * the 16 control bytes of a group at once (SSE2 where available) and only
+ * touches vertices whose control byte matches, so each weld() is a single
+ * probe sequence with no allocation per entry.
+ *
+ * @tparam T Vertex type. Must be trivially copyable and have no padding.
+ */
+template <typename T>
+class abcg::VertexWelder {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+ public:
+  /**
+   * @brief Creates a welder with room for the given number of distinct
+   * vertices before the table grows.
+   *
+   * @param expectedVertices Expected number of distinct vertices.
+   */
+  explicit VertexWelder(std::size_t expectedVertices = 0) {
+    m_vertices.reserve(expectedVertices);
+    rehash(expectedVertices);
+  }
+
+  /**
+   * @brief Returns the index of a vertex, appending it if it is new.
+   *
+   * @param vertex Vertex to look up.
+   * @return Index of the vertex in vertices().
+   */
+  std::uint32_t weld(const T &vertex) {
+    if ((m_vertices.size() + 1) * 8 > capacity() * 7) {
+      rehash(capacity());
+    }
+
+    const auto hash{hashOf(vertex)};
+    const auto fragment{static_cast<std::uint8_t>(hash & 0x7F)};
+    auto group{static_cast<std::size_t>(hash >> 7) & m_groupMask};
+    for (std::size_t step{1};; ++step) {
+      const auto *control{&m_control[group * groupSize]};
+      for (auto match{matches(control, fragment)}; match != 0;
+           match &= match - 1) {
+        const auto slot{group * groupSize +
+                        static_cast<std::size_t>(std::countr_zero(match))};
+        const auto index{m_indices[slot]};
+        if (std::memcmp(&m_vertices[index], &vertex, sizeof(T)) == 0) {
+          return index;
+        }
+      }
+      // No deletions: the first empty slot ends the probe sequence
+      if (const auto empty{matches(control, emptySlot)}; empty != 0) {
+        const auto slot{group * groupSize +
+                        static_cast<std::size_t>(std::countr_zero(empty))};
+        const auto index{static_cast<std::uint32_t>(m_vertices.size())};
+        m_control[slot] = fragment;
+        m_indices[slot] = index;
+        m_vertices.push_back(vertex);
+        return index;
+      }
+      // Triangular probing visits every group of a power-of-two table
+      group = (group + step) & m_groupMask;
+    }
+  }
+
+  /**
+   * @brief Distinct vertices, in order of first appearance.
+   */
+  [[nodiscard]] const std::vector<T> &vertices() const noexcept {
+    return m_vertices;
+  }
+
+  /**
+   * @brief Moves the distinct vertices out and clears the welder.
+   */
+  [[nodiscard]] std::vector<T> takeVertices() {
+    auto vertices{std::move(m_vertices)};
+    m_vertices.clear();
+    rehash(0);
+    return vertices;
+  }
+
+ private:
+  static constexpr std::size_t groupSize{16};
+  static constexpr std::uint8_t emptySlot{0x80};
+
+  std::vector<std::uint8_t> m_control;
+  std::vector<std::uint32_t> m_indices;
+  std::vector<T> m_vertices;
+  std::size_t m_groupMask{};
+
+  [[nodiscard]] std::size_t capacity() const noexcept {
+    return m_control.size();
+  }
+
+  // Bit i is set if control byte i of the group equals value
+  [[nodiscard]] static std::uint32_t matches(const std::uint8_t *control,
+                                             std::uint8_t value) noexcept {
+#if defined(ABCG_VERTEXWELDER_SSE2)
+    const auto bytes{
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(control))};
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(value)))));
+#else
+    std::uint32_t mask{0};
+    for (std::size_t i{0}; i < groupSize; ++i) {
+      if (control[i] == value) mask |= 1U << i;
+    }
+    return mask;
+#endif
+  }
+
+  [[nodiscard]] static std::uint64_t hashOf(const T &vertex) noexcept {
+    const auto *bytes{reinterpret_cast<const unsigned char *>(&vertex)};
+    std::uint64_t hash{0x9E3779B97F4A7C15ULL};
+    std::size_t offset{0};
+    for (; offset + sizeof(std::uint64_t) <= sizeof(T);
+         offset += sizeof(std::uint64_t)) {
+      std::uint64_t word{};
+      std::memcpy(&word, bytes + offset, sizeof(word));
+      hash = (hash ^ word) * 0xBF58476D1CE4E5B9ULL;
+      hash ^= hash >> 31;
+    }
+    if constexpr (sizeof(T) % sizeof(std::uint64_t) != 0) {
+      std::uint64_t word{};
+      std::memcpy(&word, bytes + offset, sizeof(T) - offset);
+      hash = (hash ^ word) * 0xBF58476D1CE4E5B9ULL;
+      hash ^= hash >> 31;
+    }
+    hash *= 0x94D049BB133111EBULL;
+    return hash ^ (hash >> 29);
+  }
+
+  // Resizes the table to hold at least minimumVertices at 7/8 load and
+  // reinserts the vertices already welded
+  void rehash(std::size_t minimumVertices) {
+    const auto slots{std::bit_ceil(
+        std::max<std::size_t>(groupSize, (minimumVertices * 8 + 6) / 7 + 1))};
+    m_control.assign(slots, emptySlot);
+    m_indices.assign(slots, 0);
+    m_groupMask = slots / groupSize - 1;
+
+    for (std::uint32_t index{0}; index < m_vertices.size(); ++index) {
+      const auto hash{hashOf(m_vertices[index])};
+      auto group{static_cast<std::size_t>(hash >> 7) & m_groupMask};
+      for (std::size_t step{1};; ++step) {
+        const auto *control{&m_control[group * groupSize]};
+        if (const auto empty{matches(control, emptySlot)}; empty != 0) {
+          const auto slot{group * groupSize +
+                          static_cast<std::size_t>(std::countr_zero(empty))};
+          m_control[slot] = static_cast<std::uint8_t>(hash & 0x7F);
+          m_indices[slot] = index;
+          break;
+        }
+        group = (group + step) & m_groupMask;
+      }
+    }
+  }
+};
+
+#endif
@@ -14,6 +14,6 @@ void main() {
     outColor = vec4(fragColor.r*i,fragColor.g*i,fragColor.b*i,fragColor.a); //por fora, tom entre branco e cinza
     // outColor = fragColor;
   } else {
-    outColor = vec4(0.5f, 0.5f, 0.5f, 1.0f); //por dentro, tom de cinza escuro
+    outColor = vec4(0.5f, 0.5f, 0.5f, 1.0f); //por dentro, tom de cinza escuro (só sem GL_CULL_FACE)
   }
 }
\ No newline at end of file
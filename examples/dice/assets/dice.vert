@@ -1,38 +1,16 @@
 #version 410 core
 
-layout(location = 0) in vec3 inPosition; //posição (x,y,z) do vértice
-layout(location = 1) in vec3 inColor;
+layout(location = 0) in vec3 inPosition; //posição (x,y,z) do vértice, enviada como snorm16
+layout(location = 1) in float inMaterial; //id do material: 0 = preto, 1 = branco
 
-uniform vec3 translation;
-uniform float rotationX;
-uniform float rotationY;
-uniform float rotationZ;
+//rotação e translação do dado, compostas na CPU uma vez por quadro
+uniform mat4 modelMatrix;
 
 out vec4 fragColor;
 
 void main() {
+  vec3 newPosition = (modelMatrix * vec4(inPosition, 1.0f)).xyz;
 
-  vec3 newPosition = inPosition;
-  if(rotationX > 0.0f){
-    //rotação em torno do eixo x
-    newPosition = vec3( newPosition.x,
-                    newPosition.y * cos(rotationX) - newPosition.z * sin(rotationX),
-                    newPosition.z * cos(rotationX) + newPosition.y * sin(rotationX));
-  }
-  
-  if(rotationY > 0.0f){
-    //rotação em torno do eixo y
-    newPosition = vec3( newPosition.x * cos(rotationY) + newPosition.z * sin(rotationY),
-                            newPosition.y,
-                            newPosition.z * cos(rotationY) - newPosition.x * sin(rotationY));
-  }
-  if(rotationZ > 0.0f){
-    //rotação em torno do eixo z
-    newPosition = vec3( newPosition.x * cos(rotationZ) - newPosition.y * sin(rotationZ),
-                            newPosition.y * cos(rotationZ) + newPosition.x * sin(rotationZ),
-                            newPosition.z);
-  }
-  
-  gl_Position = vec4(newPosition + translation, 2.0f); //jogar ele um pouquinho pra trás, pra ficar menor
-  fragColor = vec4(inColor, 1.0f);
+  gl_Position = vec4(newPosition, 2.0f); //jogar ele um pouquinho pra trás, pra ficar menor
+  fragColor = vec4(vec3(inMaterial), 1.0f);
 }
\ No newline at end of file
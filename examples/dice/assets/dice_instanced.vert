@@ -0,0 +1,17 @@
+#version 410 core
+
+layout(location = 0) in vec3 inPosition; //posição (x,y,z) do vértice, enviada como snorm16
+layout(location = 1) in float inMaterial; //id do material: 0 = preto, 1 = branco
+
+//atributo por instância (glVertexAttribDivisor = 1): uma matriz de modelo por dado.
+//um mat4 ocupa as localizações 2, 3, 4 e 5, uma por coluna
+layout(location = 2) in mat4 inModelMatrix;
+
+out vec4 fragColor;
+
+void main() {
+  vec3 newPosition = (inModelMatrix * vec4(inPosition, 1.0f)).xyz;
+
+  gl_Position = vec4(newPosition, 2.0f); //jogar ele um pouquinho pra trás, pra ficar menor
+  fragColor = vec4(vec3(inMaterial), 1.0f);
+}
@@ -0,0 +1,56 @@
+#version 410
+
+in vec3 fragLocal;
+
+//meio lado do cubo, na escala do modelo
+uniform float meioLado;
+
+out vec4 outColor;
+
+//pintas como no dice.obj, em frações do meio lado
+const float afastamento = 0.4; //distância do centro da face ao centro das pintas, em cada eixo
+const float raio = 0.16;
+
+//distância com sinal até a pinta mais próxima da face com n pintas (negativa dentro dela).
+//(u,v) são as coordenadas na face, em [-1,1]. A disposição segue o modelo: o 2 na antidiagonal, o 3 na diagonal,
+//o 6 em duas colunas de três ao longo de v
+float distanciaPintas(vec2 uv, int n) {
+  float d = 1e3;
+  float a = afastamento;
+  if (n == 1 || n == 3 || n == 5) d = min(d, length(uv));
+  if (n >= 3) d = min(d, min(length(uv - vec2(a, a)), length(uv + vec2(a, a))));
+  if (n == 2 || n >= 4) d = min(d, min(length(uv - vec2(a, -a)), length(uv + vec2(a, -a))));
+  if (n == 6) d = min(d, min(length(uv - vec2(a, 0.0)), length(uv + vec2(a, 0.0))));
+  return d - raio;
+}
+
+void main() {
+  //a face é o eixo em que o ponto mais se afasta do centro: +x = 1, +y = 2, +z = 4 e os opostos somam 7
+  vec3 p = abs(fragLocal);
+  int n;
+  vec2 uv;
+  if (p.x >= p.y && p.x >= p.z) {
+    n = fragLocal.x > 0.0 ? 1 : 6;
+    uv = fragLocal.yz;
+  } else if (p.y >= p.z) {
+    n = fragLocal.y > 0.0 ? 2 : 5;
+    uv = fragLocal.xz;
+  } else {
+    n = fragLocal.z > 0.0 ? 4 : 3;
+    uv = fragLocal.xy;
+  }
+  uv /= meioLado;
+
+  //borda da pinta suavizada em um pixel: branco fora, preto dentro
+  float d = distanciaPintas(uv, n);
+  float largura = max(fwidth(d), 1e-4);
+  float cor = smoothstep(-largura, largura, d);
+
+  //mesmo sombreamento do dice.frag
+  float i = 1.3 - gl_FragCoord.z;
+  if (gl_FrontFacing) {
+    outColor = vec4(vec3(cor * i), 1.0);
+  } else {
+    outColor = vec4(0.5f, 0.5f, 0.5f, 1.0f); //por dentro, tom de cinza escuro (só sem GL_CULL_FACE)
+  }
+}
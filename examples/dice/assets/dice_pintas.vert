@@ -0,0 +1,18 @@
+#version 410 core
+
+//posição no referencial das faces do dado (eixos perpendiculares às faces 1, 2 e 4), enviada como snorm16
+layout(location = 0) in vec3 inPosition;
+
+//rotação e translação do dado, compostas na CPU uma vez por quadro
+uniform mat4 modelMatrix;
+//leva o referencial das faces para o do dice.obj, para que os angulosRetos mostrem as mesmas faces
+uniform mat3 orientacaoDasFaces;
+
+out vec3 fragLocal;
+
+void main() {
+  vec3 newPosition = (modelMatrix * vec4(orientacaoDasFaces * inPosition, 1.0f)).xyz;
+
+  gl_Position = vec4(newPosition, 2.0f); //jogar ele um pouquinho pra trás, pra ficar menor
+  fragLocal = inPosition;
+}
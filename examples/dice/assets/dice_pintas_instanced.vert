@@ -0,0 +1,20 @@
+#version 410 core
+
+//posição no referencial das faces do dado (eixos perpendiculares às faces 1, 2 e 4), enviada como snorm16
+layout(location = 0) in vec3 inPosition;
+
+//atributo por instância (glVertexAttribDivisor = 1): uma matriz de modelo por dado.
+//um mat4 ocupa as localizações 2, 3, 4 e 5, uma por coluna
+layout(location = 2) in mat4 inModelMatrix;
+
+//leva o referencial das faces para o do dice.obj, para que os angulosRetos mostrem as mesmas faces
+uniform mat3 orientacaoDasFaces;
+
+out vec3 fragLocal;
+
+void main() {
+  vec3 newPosition = (inModelMatrix * vec4(orientacaoDasFaces * inPosition, 1.0f)).xyz;
+
+  gl_Position = vec4(newPosition, 2.0f); //jogar ele um pouquinho pra trás, pra ficar menor
+  fragLocal = inPosition;
+}
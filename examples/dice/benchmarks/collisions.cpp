@@ -0,0 +1,119 @@
+//compara a detecção de colisões por força bruta (todos contra todos, com glm::distance)
+//com a fase ampla em grade espacial usada por Dices::checkCollisions.
+//os dados ficam espalhados na mesa [-1.5, 1.5]², diminuídos por sqrt(3 / quantidade) para caberem sem se sobrepor
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <glm/vec2.hpp>
+#include <random>
+#include <vector>
+
+#include "spatialhash.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Mesa {
+  std::vector<glm::vec2> posicoes;
+  std::vector<glm::vec2> velocidades;
+  float distancia{};
+};
+
+Mesa criarMesa(std::size_t quantidade) {
+  std::default_random_engine engine{42};
+  std::uniform_real_distribution<float> pos(-1.5f, 1.5f);
+  std::uniform_real_distribution<float> vel(-0.05f, 0.05f);
+
+  Mesa mesa;
+  const float escala{std::min(1.0f, std::sqrt(3.0f / static_cast<float>(quantidade)))};
+  mesa.distancia = 1.2f * escala;
+  for(std::size_t i{0}; i < quantidade; ++i) {
+    mesa.posicoes.emplace_back(pos(engine), pos(engine));
+    mesa.velocidades.emplace_back(vel(engine) * escala, vel(engine) * escala);
+  }
+  return mesa;
+}
+
+void mover(Mesa &mesa) {
+  for(std::size_t i{0}; i < mesa.posicoes.size(); ++i) {
+    auto &p{mesa.posicoes[i]};
+    auto &v{mesa.velocidades[i]};
+    p += v;
+    if(std::abs(p.x) > 1.5f) v.x = -v.x;
+    if(std::abs(p.y) > 1.5f) v.y = -v.y;
+  }
+}
+
+std::size_t forcaBruta(const Mesa &mesa) {
+  std::size_t colisoes{0};
+  for(std::size_t i{0}; i < mesa.posicoes.size(); ++i) {
+    for(std::size_t j{0}; j < mesa.posicoes.size(); ++j) {
+      if(i != j && glm::distance(mesa.posicoes[i], mesa.posicoes[j]) < mesa.distancia) {
+        ++colisoes;
+        break;
+      }
+    }
+  }
+  return colisoes;
+}
+
+std::size_t gradeEspacial(const Mesa &mesa, SpatialHash &grade) {
+  const float distancia2{mesa.distancia * mesa.distancia};
+  std::size_t colisoes{0};
+  for(std::uint32_t i{0}; i < mesa.posicoes.size(); ++i) {
+    grade.update(i, mesa.posicoes[i]);
+  }
+  for(std::uint32_t i{0}; i < mesa.posicoes.size(); ++i) {
+    bool colidindo{false};
+    grade.forEachNear(mesa.posicoes[i], [&](std::uint32_t j) {
+      if(j == i) return true;
+      const auto d{mesa.posicoes[j] - mesa.posicoes[i]};
+      colidindo = glm::dot(d, d) < distancia2;
+      return !colidindo;
+    });
+    if(colidindo) ++colisoes;
+  }
+  return colisoes;
+}
+
+//tempo médio por passo, em milissegundos
+template <typename F>
+double medir(Mesa mesa, int passos, F &&detectar, std::size_t &colisoes) {
+  colisoes = 0;
+  const auto inicio{Clock::now()};
+  for(int passo{0}; passo < passos; ++passo) {
+    mover(mesa);
+    colisoes += detectar(mesa);
+  }
+  const std::chrono::duration<double, std::milli> total{Clock::now() - inicio};
+  return total.count() / passos;
+}
+}  // namespace
+
+int main() {
+  fmt::print("{:>8} {:>16} {:>16} {:>10}\n", "dados", "forca bruta (ms)", "grade (ms)", "ganho");
+  for(const std::size_t quantidade : {std::size_t{10}, std::size_t{1000}, std::size_t{100000}}) {
+    const auto mesa{criarMesa(quantidade)};
+    //a força bruta é quadrática; limitamos o número de passos para o benchmark terminar
+    const int passosBruta{static_cast<int>(std::clamp<double>(2e8 / static_cast<double>(quantidade * quantidade), 1.0, 1000.0))};
+    const int passosGrade{static_cast<int>(std::clamp<double>(2e7 / static_cast<double>(quantidade), 10.0, 1000.0))};
+
+    std::size_t colisoesBruta{};
+    const double tempoBruta{medir(mesa, passosBruta, forcaBruta, colisoesBruta)};
+
+    SpatialHash grade;
+    grade.reset(mesa.distancia, quantidade);
+    for(std::uint32_t i{0}; i < quantidade; ++i) grade.insert(i, mesa.posicoes[i]);
+    std::size_t colisoesGrade{};
+    const double tempoGrade{medir(mesa, passosGrade, [&](const Mesa &m) { return gradeEspacial(m, grade); }, colisoesGrade)};
+
+    fmt::print("{:>8} {:>16.4f} {:>16.4f} {:>9.1f}x   (colisoes/passo: {:.1f} vs {:.1f})\n", quantidade,
+               tempoBruta, tempoGrade, tempoBruta / tempoGrade,
+               static_cast<double>(colisoesBruta) / passosBruta,
+               static_cast<double>(colisoesGrade) / passosGrade);
+  }
+  return 0;
+}
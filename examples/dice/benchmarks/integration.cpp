@@ -0,0 +1,75 @@
+//mede um passo de integração (quique nas paredes, deslocamento, giro e tempo de giro)
+//sobre 1 milhão de dados girando, com cada kernel disponível no processador
+#include <fmt/core.h>
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include "integration.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+DiceState criarEstado(std::size_t quantidade) {
+  std::default_random_engine engine{42};
+  std::uniform_real_distribution<float> pos(-1.5f, 1.5f);
+  std::uniform_real_distribution<float> vel(-6.0f, 6.0f);
+  std::uniform_real_distribution<float> velAngular(4.0f, 8.0f);
+  std::uniform_int_distribution<std::int32_t> passos(240, 600); //2 a 5 s a 120 passos/s
+
+  DiceState estado;
+  estado.resize(quantidade);
+  for(std::size_t i{0}; i < quantidade; ++i) {
+    estado.posX[i] = pos(engine);
+    estado.posY[i] = pos(engine);
+    estado.velX[i] = vel(engine);
+    estado.velY[i] = vel(engine);
+    estado.velAngX[i] = velAngular(engine);
+    estado.passosRestantes[i] = passos(engine);
+  }
+  return estado;
+}
+}  // namespace
+
+int main() {
+  constexpr std::size_t quantidade{1'000'000};
+  constexpr int passos{300};
+  constexpr float dt{1.0f / 120.0f};
+
+  const auto inicial{criarEstado(quantidade)};
+
+  //resultado escalar como referência para conferir os kernels vetorizados
+  auto referencia{inicial};
+  EventosPasso eventosReferencia;
+  std::size_t pousosReferencia{0};
+  for(int passo{0}; passo < passos; ++passo) {
+    integrarPasso(referencia, referencia.size(), dt, 1.5f, eventosReferencia, KernelIntegracao::Escalar);
+    pousosReferencia += eventosReferencia.pousos.size();
+  }
+
+  fmt::print("{} dados, {} passos\n", quantidade, passos);
+  for(const auto kernel : {KernelIntegracao::Escalar, KernelIntegracao::SSE41, KernelIntegracao::AVX2}) {
+    if(static_cast<int>(kernel) > static_cast<int>(melhorKernel())) break;
+
+    auto estado{inicial};
+    EventosPasso eventos;
+    std::size_t pousos{0};
+    const auto inicio{Clock::now()};
+    for(int passo{0}; passo < passos; ++passo) {
+      integrarPasso(estado, estado.size(), dt, 1.5f, eventos, kernel);
+      pousos += eventos.pousos.size();
+    }
+    const std::chrono::duration<double, std::milli> total{Clock::now() - inicio};
+
+    float erro{0.0f};
+    for(std::size_t i{0}; i < quantidade; ++i) {
+      erro = std::max(erro, std::abs(estado.posX[i] - referencia.posX[i]));
+    }
+    fmt::print("{:>8}: {:8.3f} ms/passo  ({:.1f} M dados/ms)  pousos: {}/{}  erro max. em x: {:.2e}\n",
+               nomeKernel(kernel), total.count() / passos,
+               static_cast<double>(quantidade) * passos / total.count() / 1e6, pousos,
+               pousosReferencia, erro);
+  }
+  return 0;
+}
@@ -0,0 +1,43 @@
+//lançamentos por segundo do motor de Monte Carlo com 1, 2, 4, ... threads até o número de núcleos.
+//o histograma tem que ser idêntico em todas as linhas: ele depende só da semente, não da divisão do trabalho
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "montecarlo.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  const std::uint64_t lancamentos{argc > 1 ? std::stoull(argv[1]) : 1'000'000ULL};
+  constexpr std::uint64_t semente{42};
+
+  const unsigned nucleos{std::max(1u, std::thread::hardware_concurrency())};
+  std::vector<unsigned> contagens;
+  for(unsigned threads{1}; threads < nucleos; threads *= 2) contagens.push_back(threads);
+  contagens.push_back(nucleos);
+
+  fmt::print("{} lancamentos, {} nucleos\n", lancamentos, nucleos);
+  fmt::print("{:>8} {:>14} {:>10} {:>10}   faces 1..6\n", "threads", "lanc./s", "ganho", "qui2");
+  double base{0.0};
+  for(const auto threads : contagens) {
+    WorkStealingPool pool{threads};
+
+    const auto inicio{Clock::now()};
+    const auto histograma{lancarEmLote(pool, lancamentos, semente)};
+    const std::chrono::duration<double> total{Clock::now() - inicio};
+
+    const double taxa{static_cast<double>(lancamentos) / total.count()};
+    if(base == 0.0) base = taxa;
+    const auto &c{histograma.contagem};
+    fmt::print("{:>8} {:>14.0f} {:>9.2f}x {:>10.2f}   {} {} {} {} {} {}\n", threads, taxa, taxa / base,
+               histograma.quiQuadrado(), c[1], c[2], c[3], c[4], c[5], c[6]);
+  }
+  return 0;
+}
@@ -0,0 +1,107 @@
+//compara o tinyobj com o abcg::readObj no dice.obj e num .obj sintético (uma grade de triângulos),
+//medindo o tempo de leitura e conferindo que os dois produzem a mesma geometria.
+//uso: dice_objparser_bench [dice.obj] [triangulos do arquivo sintético]
+#include <fmt/core.h>
+#include <tiny_obj_loader.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "abcg_objreader.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+//grade de lado n x n vértices com dois triângulos por célula, alternando entre dois materiais
+void gerarObj(const std::filesystem::path &path, std::size_t triangulos) {
+  const auto lado{static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(triangulos) / 2.0))) + 1};
+  std::ofstream mtl{std::filesystem::path{path}.replace_extension(".mtl")};
+  mtl << "newmtl black\nKd 0 0 0\n\nnewmtl white\nKd 1 1 1\n";
+
+  std::ofstream obj{path};
+  obj << "mtllib " << std::filesystem::path{path}.replace_extension(".mtl").filename().string() << "\n";
+  for(std::size_t y{0}; y < lado; ++y) {
+    for(std::size_t x{0}; x < lado; ++x) {
+      obj << fmt::format("v {:.6f} {:.6f} {:.6f}\n", static_cast<double>(x) / lado,
+                         static_cast<double>(y) / lado, std::sin(static_cast<double>(x * y)) * 0.01);
+    }
+  }
+  std::size_t escritos{0};
+  for(std::size_t y{0}; y + 1 < lado && escritos < triangulos; ++y) {
+    obj << (y % 2 == 0 ? "usemtl black\n" : "usemtl white\n");
+    for(std::size_t x{0}; x + 1 < lado && escritos < triangulos; ++x, escritos += 2) {
+      const auto v{y * lado + x + 1};
+      obj << fmt::format("f {}//1 {}//1 {}//1\nf {}//1 {}//1 {}//1\n", v, v + 1, v + lado, v + 1,
+                         v + lado + 1, v + lado);
+    }
+  }
+}
+
+template <typename F>
+double medir(F &&funcao) {
+  const auto inicio{Clock::now()};
+  funcao();
+  return std::chrono::duration<double, std::milli>(Clock::now() - inicio).count();
+}
+
+void comparar(const std::string &path) {
+  tinyobj::ObjReader reader;
+  const double tempoTiny{medir([&] { reader.ParseFromFile(path); })};
+
+  //mesma comparação que o carregador do exemplo faz: posição de cada canto de triângulo e material
+  const auto &attrib{reader.GetAttrib()};
+  std::size_t triangulosTiny{0};
+  for(const auto &shape : reader.GetShapes()) triangulosTiny += shape.mesh.material_ids.size();
+
+  fmt::print("{}\n", path);
+  fmt::print("  {:>10}: {:9.2f} ms  ({} vertices, {} triangulos)\n", "tinyobj", tempoTiny,
+             attrib.vertices.size() / 3, triangulosTiny);
+
+  const unsigned nucleos{std::max(1u, std::thread::hardware_concurrency())};
+  std::vector<unsigned> contagens;
+  for(unsigned threads{1}; threads < nucleos; threads *= 2) contagens.push_back(threads);
+  contagens.push_back(nucleos);
+
+  for(const auto threads : contagens) {
+    abcg::ObjMesh mesh;
+    const double tempo{medir([&] { mesh = abcg::readObj(path, threads); })};
+
+    std::size_t diferencas{0};
+    std::size_t canto{0};
+    for(const auto &shape : reader.GetShapes()) {
+      for(std::size_t i{0}; i < shape.mesh.indices.size(); ++i, ++canto) {
+        const auto a{static_cast<std::size_t>(shape.mesh.indices[i].vertex_index)};
+        const auto b{static_cast<std::size_t>(mesh.indices[canto])};
+        if(attrib.vertices[3 * a] != mesh.positions[3 * b] ||
+           attrib.vertices[3 * a + 1] != mesh.positions[3 * b + 1] ||
+           attrib.vertices[3 * a + 2] != mesh.positions[3 * b + 2] ||
+           shape.mesh.material_ids[i / 3] != mesh.materialIds[canto / 3]) {
+          ++diferencas;
+        }
+      }
+    }
+    fmt::print("  {:>7} {:>2}: {:9.2f} ms  ({:.1f}x)  cantos diferentes: {}\n", "readObj", threads, tempo,
+               tempoTiny / tempo, diferencas + (canto != mesh.indices.size() ? 1 : 0));
+  }
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  const std::string dice{argc > 1 ? argv[1] : "assets/dice.obj"};
+  const std::size_t triangulos{argc > 2 ? std::stoull(argv[2]) : 10'000'000};
+
+  comparar(dice);
+
+  const auto sintetico{std::filesystem::temp_directory_path() / "dice_objparser_bench.obj"};
+  gerarObj(sintetico, triangulos);
+  comparar(sintetico.string());
+  std::filesystem::remove(sintetico);
+  std::filesystem::remove(std::filesystem::path{sintetico}.replace_extension(".mtl"));
+  return 0;
+}
@@ -0,0 +1,157 @@
+//compara o caminho antigo de deduplicação de vértices (std::unordered_map com hash só da posição,
+//três buscas por canto) com o abcg::VertexWelder (chave posição + cor, uma busca por canto),
+//no dice.obj e numa malha sintética grande.
+//uso: dice_welder_bench [dice.obj] [triangulos da malha sintética]
+#include <fmt/core.h>
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "abcg_objreader.hpp"
+#include "abcg_vertexwelder.hpp"
+#include "model.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+//um vértice por canto de triângulo, como o carregador os monta antes de deduplicar
+std::vector<Vertex> cantos(const abcg::ObjMesh &mesh) {
+  std::vector<Vertex> resultado(mesh.indices.size());
+  for(std::size_t canto{0}; canto < mesh.indices.size(); ++canto) {
+    const auto *p{&mesh.positions[3 * std::size_t{mesh.indices[canto]}]};
+    const auto material{static_cast<float>(mesh.materialIds[canto / 3])};
+    resultado[canto] = {{p[0], p[1], p[2]}, {material, material, material}};
+  }
+  return resultado;
+}
+
+//grade de lado n x n com dois triângulos por célula; cada linha de células tem sua cor,
+//então os vértices das linhas de borda aparecem com duas cores
+std::vector<Vertex> grade(std::size_t triangulos) {
+  const auto lado{static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(triangulos) / 2.0))) + 1};
+  std::vector<Vertex> resultado;
+  resultado.reserve(triangulos * 3);
+  const auto vertice{[lado](std::size_t x, std::size_t y, float cor) {
+    return Vertex{{static_cast<float>(x) / lado, static_cast<float>(y) / lado, std::sin(static_cast<float>(x * y)) * 0.01f},
+                  {cor, cor, cor}};
+  }};
+  for(std::size_t y{0}; y + 1 < lado && resultado.size() < triangulos * 3; ++y) {
+    const float cor{static_cast<float>(y % 2)};
+    for(std::size_t x{0}; x + 1 < lado && resultado.size() < triangulos * 3; ++x) {
+      for(const auto &[vx, vy] : {std::pair{x, y}, {x + 1, y}, {x, y + 1}, {x + 1, y}, {x + 1, y + 1}, {x, y + 1}}) {
+        resultado.push_back(vertice(vx, vy, cor));
+      }
+    }
+  }
+  return resultado;
+}
+
+//hash e igualdade do caminho antigo: só a posição
+struct HashPosicao {
+  std::size_t operator()(const Vertex &vertex) const noexcept {
+    const auto h{[](float f) { return std::hash<float>{}(f); }};
+    return h(vertex.position.x) ^ (h(vertex.position.y) << 1) ^ (h(vertex.position.z) << 2);
+  }
+};
+struct IgualPosicao {
+  bool operator()(const Vertex &a, const Vertex &b) const noexcept { return a.position == b.position; }
+};
+
+//unordered_map com chave completa e uma única busca (try_emplace), para separar o ganho da tabela do ganho da chave
+struct HashCompleto {
+  std::size_t operator()(const Vertex &vertex) const noexcept {
+    return HashPosicao{}(vertex) ^ (std::hash<float>{}(vertex.color.r) << 3);
+  }
+};
+
+struct Resultado {
+  double ms{};
+  std::size_t vertices{};
+  std::vector<std::uint32_t> indices;
+};
+
+template <typename F>
+Resultado medir(const std::vector<Vertex> &entrada, int repeticoes, F &&soldar) {
+  Resultado melhor;
+  melhor.ms = 1e30;
+  for(int r{0}; r < repeticoes; ++r) {
+    Resultado atual;
+    atual.indices.reserve(entrada.size());
+    const auto inicio{Clock::now()};
+    atual.vertices = soldar(entrada, atual.indices);
+    atual.ms = std::chrono::duration<double, std::milli>(Clock::now() - inicio).count();
+    if(atual.ms < melhor.ms) melhor = std::move(atual);
+  }
+  return melhor;
+}
+
+//quantos cantos apontam para um vértice com atributos diferentes dos seus
+std::size_t errados(const std::vector<Vertex> &entrada, const std::vector<Vertex> &vertices,
+                    const std::vector<std::uint32_t> &indices) {
+  std::size_t total{0};
+  for(std::size_t i{0}; i < entrada.size(); ++i) total += vertices[indices[i]] == entrada[i] ? 0 : 1;
+  return total;
+}
+
+void comparar(const std::string &nome, const std::vector<Vertex> &entrada) {
+  const int repeticoes{entrada.size() > 10'000'000 ? 3 : 10};
+  fmt::print("{} ({} cantos)\n", nome, entrada.size());
+
+  std::vector<Vertex> verticesAntigo;
+  const auto antigo{medir(entrada, repeticoes, [&](const auto &cantos, auto &indices) {
+    verticesAntigo.clear();
+    std::unordered_map<Vertex, std::uint32_t, HashPosicao, IgualPosicao> hash{};
+    hash.reserve(cantos.size() / 6);
+    for(const auto &vertex : cantos) {
+      if(hash.count(vertex) == 0) {
+        hash[vertex] = static_cast<std::uint32_t>(verticesAntigo.size());
+        verticesAntigo.push_back(vertex);
+      }
+      indices.push_back(hash[vertex]);
+    }
+    return verticesAntigo.size();
+  })};
+
+  std::vector<Vertex> verticesMapa;
+  const auto mapa{medir(entrada, repeticoes, [&](const auto &cantos, auto &indices) {
+    verticesMapa.clear();
+    std::unordered_map<Vertex, std::uint32_t, HashCompleto> hash{};
+    hash.reserve(cantos.size() / 6);
+    for(const auto &vertex : cantos) {
+      const auto [it, novo]{hash.try_emplace(vertex, static_cast<std::uint32_t>(verticesMapa.size()))};
+      if(novo) verticesMapa.push_back(vertex);
+      indices.push_back(it->second);
+    }
+    return verticesMapa.size();
+  })};
+
+  std::vector<Vertex> verticesWelder;
+  const auto welder{medir(entrada, repeticoes, [&](const auto &cantos, auto &indices) {
+    abcg::VertexWelder<Vertex> soldador{cantos.size() / 6};
+    for(const auto &vertex : cantos) indices.push_back(soldador.weld(vertex));
+    verticesWelder = soldador.takeVertices();
+    return verticesWelder.size();
+  })};
+
+  const auto imprimir{[&](const char *rotulo, const Resultado &r, const std::vector<Vertex> &vertices) {
+    fmt::print("  {:<28}: {:8.2f} ms  ({:.1f}x)  {} vertices, {} cantos com cor errada\n", rotulo, r.ms,
+               antigo.ms / r.ms, r.vertices, errados(entrada, vertices, r.indices));
+  }};
+  imprimir("unordered_map, posicao", antigo, verticesAntigo);
+  imprimir("unordered_map, posicao + cor", mapa, verticesMapa);
+  imprimir("abcg::VertexWelder", welder, verticesWelder);
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  const std::string dice{argc > 1 ? argv[1] : "assets/dice.obj"};
+  const std::size_t triangulos{argc > 2 ? std::stoull(argv[2]) : 4'000'000};
+
+  comparar(dice, cantos(abcg::readObj(dice)));
+  comparar(fmt::format("grade sintetica, {} triangulos", triangulos), grade(triangulos));
+  return 0;
+}
@@ -0,0 +1,129 @@
+//verifica BufferDeInstancias sobre um anel na memória com a interface de abcg::RingBuffer, sem contexto OpenGL.
+//a cada quadro, faixas aleatórias do arranjo mudam, ele cresce e encolhe de vez em quando, e depois do envio a
+//região devolvida tem que conter o arranjo inteiro. Como um driver que perde o conteúdo do buffer mapeado, o anel
+//faz um a cada 53 unmaps falhar e enche a região de lixo: a região fica errada nesse quadro, mas tem que estar
+//certa de novo da próxima vez que for escrita. Termina com código 1 na primeira falha
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "faixas.hpp"
+
+namespace {
+constexpr std::byte lixo{0xEE};
+
+//como o caminho sem mapeamento persistente de abcg::RingBuffer: map dá uma cópia da região (ou lixo, se ela pode
+//ser descartada) e só as faixas passadas a flush chegam ao buffer
+class AnelNaMemoria {
+  public:
+    void create(GLsizeiptr regionSize, std::size_t regionCount) {
+      m_regionSize = regionSize;
+      m_regions = regionCount;
+      m_region = regionCount - 1;
+      m_buffer.assign(static_cast<std::size_t>(regionSize) * regionCount, lixo);
+      ++m_nome;
+    }
+    void destroy() {
+      m_buffer.clear();
+      m_nome = 0;
+    }
+    [[nodiscard]] std::byte *map(bool discard) {
+      m_region = (m_region + 1) % m_regions;
+      const auto inicio{m_buffer.begin() + regionOffset()};
+      m_mapeada.assign(inicio, inicio + m_regionSize);
+      if(discard) std::fill(m_mapeada.begin(), m_mapeada.end(), lixo);
+      return m_mapeada.data();
+    }
+    void flush(GLintptr offset, GLsizeiptr size) {
+      std::copy_n(m_mapeada.begin() + offset, size, m_buffer.begin() + regionOffset() + offset);
+    }
+    [[nodiscard]] bool unmap() {
+      if(++m_unmaps % 53 != 0) return true;
+      std::fill_n(m_buffer.begin() + regionOffset(), m_regionSize, lixo);
+      ++m_perdas;
+      return false;
+    }
+    [[nodiscard]] GLintptr regionOffset() const noexcept {
+      return m_regionSize * static_cast<GLintptr>(m_region);
+    }
+    void fence() {}
+    [[nodiscard]] GLuint buffer() const noexcept { return m_nome; }
+
+    [[nodiscard]] const std::byte *regiao() const noexcept { return m_buffer.data() + regionOffset(); }
+    [[nodiscard]] int perdas() const noexcept { return m_perdas; }
+
+  private:
+    std::vector<std::byte> m_buffer;
+    std::vector<std::byte> m_mapeada;
+    GLsizeiptr m_regionSize{};
+    std::size_t m_regions{1};
+    std::size_t m_region{};
+    GLuint m_nome{};
+    int m_unmaps{};
+    int m_perdas{};
+};
+
+struct Instancia {
+  std::uint32_t indice;
+  std::uint32_t versao;
+};
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  const int quadros{argc > 1 ? std::stoi(argv[1]) : 6000};
+
+  BufferDeInstancias<Instancia, AnelNaMemoria> instancias;
+  std::vector<Instancia> dados(300);
+  for(std::uint32_t index{0}; index < dados.size(); ++index) dados[index] = {index, 0};
+
+  std::mt19937 gerador{7};
+  std::vector<FaixaAlterada> faixas;
+  int verificados{0};
+  int ultimasPerdas{0};
+  for(int quadro{1}; quadro <= quadros; ++quadro) {
+    faixas.clear();
+    const auto operacao{gerador() % 40};
+    if(operacao == 0) {
+      //cresce além da capacidade de vez em quando, o que recria o anel
+      const auto antes{dados.size()};
+      dados.resize(antes + 1 + gerador() % 400);
+      faixas.push_back({antes, dados.size()});
+    }
+    else if(operacao == 1 && dados.size() > 10) {
+      dados.resize(dados.size() - 1 - gerador() % (dados.size() / 2));
+    }
+    //faixas sobrepostas, fora de ordem e até além do fim, como Dices pode mandar
+    const auto quantidade{gerador() % 4};
+    for(std::uint32_t k{0}; k < quantidade; ++k) {
+      const auto inicio{gerador() % (dados.size() + 5)};
+      const auto fim{inicio + gerador() % 50};
+      for(auto index{inicio}; index < std::min<std::size_t>(fim, dados.size()); ++index) {
+        dados[index] = {static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(quadro)};
+      }
+      faixas.push_back({inicio, fim});
+    }
+
+    const auto deslocamento{instancias.enviar(dados, faixas)};
+    const auto &anel{instancias.anel()};
+    if(anel.perdas() != ultimasPerdas) {
+      //o conteúdo desta região se perdeu: só a próxima escrita dela é conferida
+      ultimasPerdas = anel.perdas();
+      continue;
+    }
+    if(deslocamento != anel.regionOffset() ||
+       std::memcmp(anel.regiao(), dados.data(), dados.size() * sizeof(Instancia)) != 0) {
+      fmt::print("quadro {}: a região enviada não tem o arranjo inteiro ({} instâncias)\n", quadro, dados.size());
+      return 1;
+    }
+    ++verificados;
+  }
+  fmt::print("ok: {} quadros, {} regiões conferidas, {} mapeamentos perdidos\n", quadros, verificados,
+             instancias.anel().perdas());
+  return 0;
+}
@@ -0,0 +1,128 @@
+//verifica a mesa de dados sob entradas e saídas aleatórias de dados, lançamentos avulsos e passos de simulação:
+//- os dados dormindo estão parados e com a pose anterior igual à atual;
+//- todo handle vivo leva a um índice cujo handle é ele mesmo;
+//- todo dado parado mostra a face que faceDoLancamento sorteia para o id e o lançamento dele;
+//- até a capacidade reservada, os arranjos de estado não realocam;
+//- duas mesas com a mesma semente e as mesmas operações terminam com o mesmo estado, dado a dado.
+//termina com código 1 na primeira falha
+#include <fmt/core.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "simulation.hpp"
+
+namespace {
+constexpr std::uint64_t semente{99};
+constexpr std::size_t capacidade{2000};
+
+struct Mesa {
+  DiceSimulation simulacao;
+  std::vector<DiceHandle> vivos; //handles de todos os dados na mesa, em ordem de entrada
+};
+
+//mesma sequência de operações para a mesma semente do gerador de operações
+bool executar(Mesa &mesa, std::uint32_t operacoes, int quadros) {
+  auto &s{mesa.simulacao};
+  s.reset(300, semente);
+  s.reservar(capacidade);
+  mesa.vivos.clear();
+  for(std::size_t index{0}; index < s.size(); ++index) mesa.vivos.push_back(s.handle(index));
+  const auto *arranjo{s.estado().posX.data()};
+
+  std::mt19937 gerador{operacoes};
+  for(int quadro{0}; quadro < quadros; ++quadro) {
+    auto &vivos{mesa.vivos};
+    const auto operacao{gerador() % 6};
+    if(operacao == 0 && s.size() < capacidade) {
+      vivos.push_back(s.adicionar());
+    }
+    else if(operacao == 1 && !vivos.empty()) {
+      const auto k{gerador() % vivos.size()};
+      if(!s.remover(vivos[k])) {
+        fmt::print("quadro {}: remover recusou um handle vivo\n", quadro);
+        return false;
+      }
+      vivos[k] = vivos.back();
+      vivos.pop_back();
+    }
+    else if(operacao == 2 && !vivos.empty()) {
+      if(!s.jogarDado(vivos[gerador() % vivos.size()])) {
+        fmt::print("quadro {}: jogarDado recusou um handle vivo\n", quadro);
+        return false;
+      }
+    }
+    if(quadro % 3 == 0) s.passo();
+    if(quadro % 5000 == 0) s.jogarDados();
+    if(quadro % 11 == 0) s.limparAlterados();
+
+    const auto &e{s.estado()};
+    if(e.posX.data() != arranjo) {
+      fmt::print("quadro {}: os arranjos realocaram com {} dados e capacidade {}\n", quadro, s.size(), capacidade);
+      return false;
+    }
+    if(s.size() != vivos.size()) {
+      fmt::print("quadro {}: {} dados na mesa e {} handles vivos\n", quadro, s.size(), vivos.size());
+      return false;
+    }
+    for(auto index{s.acordados()}; index < s.size(); ++index) {
+      if(e.passosRestantes[index] != 0 || e.posX[index] != e.posXAnterior[index] ||
+         e.posY[index] != e.posYAnterior[index] || e.angX[index] != e.angXAnterior[index]) {
+        fmt::print("quadro {}: o dado {} dorme mas não está parado\n", quadro, index);
+        return false;
+      }
+    }
+    for(std::size_t index{0}; index < s.size(); ++index) {
+      if(s.girando(index)) continue;
+      if(s.face(index) != DiceSimulation::faceDoLancamento(semente, e.id[index], e.lancamento[index])) {
+        fmt::print("quadro {}: o dado {} pousou numa face diferente da sorteada\n", quadro, index);
+        return false;
+      }
+    }
+    for(const auto &dado : vivos) {
+      const auto index{s.indice(dado)};
+      if(!index || !(s.handle(*index) == dado)) {
+        fmt::print("quadro {}: handle vivo sem índice válido\n", quadro);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//compara o estado das duas mesas dado a dado, pelo handle (os índices dependem só das operações, mas o
+//handle é o que os usuários da simulação guardam)
+bool iguais(const Mesa &a, const Mesa &b) {
+  if(a.vivos.size() != b.vivos.size()) return false;
+  const auto &ea{a.simulacao.estado()};
+  const auto &eb{b.simulacao.estado()};
+  for(std::size_t k{0}; k < a.vivos.size(); ++k) {
+    const auto ia{a.simulacao.indice(a.vivos[k])};
+    const auto ib{b.simulacao.indice(b.vivos[k])};
+    if(!ia || !ib) return false;
+    if(ea.id[*ia] != eb.id[*ib] || ea.posX[*ia] != eb.posX[*ib] || ea.posY[*ia] != eb.posY[*ib] ||
+       ea.angX[*ia] != eb.angX[*ib] || ea.angY[*ia] != eb.angY[*ib] || ea.angZ[*ia] != eb.angZ[*ib] ||
+       ea.passosRestantes[*ia] != eb.passosRestantes[*ib] || ea.face[*ia] != eb.face[*ib]) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  const int quadros{argc > 1 ? std::stoi(argv[1]) : 30000};
+
+  Mesa primeira;
+  Mesa segunda;
+  if(!executar(primeira, 1, quadros) || !executar(segunda, 1, quadros)) return 1;
+  if(!iguais(primeira, segunda)) {
+    fmt::print("mesmas operações e mesma semente terminaram em estados diferentes\n");
+    return 1;
+  }
+  fmt::print("ok: {} quadros, {} dados no fim, {} acordados\n", quadros, primeira.simulacao.size(),
+             primeira.simulacao.acordados());
+  return 0;
+}
@@ -1,291 +1,429 @@
 #include "dices.hpp"
-#include <imgui.h>
-#include <glm/gtx/fast_trigonometry.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <fmt/core.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 
-void Dices::initializeGL(GLuint program, int quantity, std::vector<Vertex> vertices, std::vector<GLuint> indices, int verticesToDraw){
+void Dices::initializeGL(GLuint program, GLuint instancedProgram, int quantity, std::shared_ptr<const DiceMesh> mesh){
   terminateGL();
-  // Inicializar gerador de números pseudo-aleatórios
-  auto seed{std::chrono::steady_clock::now().time_since_epoch().count()};
-  m_randomEngine.seed(seed);
+
+  usarMalha(program, instancedProgram, std::move(mesh));
+
+  const auto quantidade{static_cast<std::size_t>(std::max(quantity, 0))};
+  reservar(quantidade);
+  m_simulacao.reset(quantidade);
+}
+
+//a simulação não muda: os dados continuam onde estão, no meio do lançamento ou não. Só o que depende da malha
+//é refeito: o VAO instanciado, que usa o VBO e o EBO dela. Os níveis de detalhe podem ser outros, então todos
+//os dados são reagrupados e reenviados
+void Dices::usarMalha(GLuint program, GLuint instancedProgram, std::shared_ptr<const DiceMesh> mesh){
+  abcg::glDeleteVertexArrays(1, &m_instanceVAO);
+  m_instanceVAO = 0;
 
   m_program = program;
-  m_vertices = vertices;
-  m_indices = indices;
-  m_verticesToDraw = verticesToDraw;
+  m_instancedProgram = instancedProgram;
+
+  //localizações de uniformes e atributos são consultadas uma única vez, logo após a ligação dos shaders
+  m_reflection = abcg::ProgramReflection{m_program};
+  m_modelMatrixUniform = m_reflection.uniform<glm::mat4>("modelMatrix");
+  m_modelMatrixAttribute = -1;
+  if(m_instancedProgram != 0) {
+    m_instancedReflection = abcg::ProgramReflection{m_instancedProgram};
+    m_modelMatrixAttribute = m_instancedReflection.attributeLocation("inModelMatrix");
+  }
 
-  m_dices.clear();
-  m_dices.resize(quantity);
+  m_mesh = std::move(mesh);
+  if(m_instancedProgram != 0) {
+    criarBufferDeInstancias();
+  }
 
-  //fmt::print("m_program: {}\n", m_program);
-  //fmt::print("m_vertices.size(): {}\n", m_vertices.size());
-  //fmt::print("m_indices.size(): {}\n", m_indices.size());
-  //fmt::print("m_verticesToDraw: {}\n", m_verticesToDraw);
+  m_tudoAlterado = true;
+  m_grupoUnico = espalhados;
+  m_grupoDoDado.clear();
+}
+
+void Dices::resize(int quantity){
+  const auto quantidade{static_cast<std::size_t>(std::max(quantity, 0))};
+  reservar(quantidade);
+  m_simulacao.redimensionar(quantidade);
+}
+
+//capacidade para a mesa e mais folgaParaAvulsos dados, para que os botões +1 e -1 não realoquem nada por dado.
+//além disso os arranjos crescem normalmente, dobrando a capacidade
+void Dices::reservar(std::size_t quantidade){
+  const auto capacidade{quantidade + folgaParaAvulsos};
+  m_simulacao.reservar(capacidade);
+  m_modelMatrices.reserve(capacidade);
+  m_grupoDoDado.reserve(capacidade);
+}
 
-  for(auto &dice : m_dices) {
-    dice = inicializarDado();
+DiceHandle Dices::adicionarDado(){
+  return m_simulacao.adicionar();
+}
+
+bool Dices::removerDado(DiceHandle dado){
+  return m_simulacao.remover(dado);
+}
+
+void Dices::jogarDados(){
+  m_simulacao.jogarDados();
+}
+
+void Dices::resizeGL(int width, int height){
+  (void)width;
+  //o tamanho projetado dos dados muda: os níveis de detalhe são escolhidos de novo
+  if(std::max(height, 1) != m_alturaDaTela) m_tudoAlterado = true;
+  m_alturaDaTela = std::max(height, 1);
+}
+
+//nível mais simples cujo erro, projetado na tela, não passa de um pixel.
+//o vertex shader divide a posição por w = 2 e o NDC [-1,1] ocupa a altura da tela, então uma unidade do modelo
+//com escala s mede s * altura / 4 pixels
+std::size_t Dices::escolherNivel(const glm::mat4 &modelMatrix) const{
+  constexpr float erroEmPixels{1.0f};
+  const float escala{glm::length(glm::vec3{modelMatrix[0]})};
+  const float pixelsPorUnidade{escala * static_cast<float>(m_alturaDaTela) / 4.0f};
+  if(!m_niveisDeDetalhe) return 0;
+  std::size_t nivel{0};
+  while(nivel + 1 < m_mesh->m_niveis.size() && m_mesh->m_niveis[nivel + 1].m_erro * pixelsPorUnidade <= erroEmPixels){
+    ++nivel;
   }
-  
+  return nivel;
 }
 
-void Dices::paintGL(int viewportWidth, int viewportHeight, float deltaTime){
-  m_deltaTime = deltaTime;
-  m_viewportWidth = viewportWidth;
-  m_viewportHeight = viewportHeight;
+void Dices::update(double deltaTime){
+  m_simulacao.update(deltaTime);
+}
 
-  abcg::glUseProgram(m_program); //usar shaders
-    
-  for(auto &dice : m_dices){
-    abcg::glBindVertexArray(dice.m_VAO); //usar vao
-
-    //Dado sendo girado, temos que definir algumas variáveis para ilustrar seu giro de forma realista
-    if(dice.dadoGirando){
-      checkCollisions(dice);
-
-      dice.quadros++;
-      if(dice.translation.x >= 1.5f) {
-        dice.movimentoDado.x = false;
-        velocidadeAngularAleatoria(dice);
-        velocidadeDirecionalAleatoria(dice);
-      }
-      else if (dice.translation.x <= -1.5f) {
-        dice.movimentoDado.x = true;
-        velocidadeAngularAleatoria(dice);
-        velocidadeDirecionalAleatoria(dice);
-      }
+void Dices::paintGL(){
+  //mudar de modo troca os grupos dos dados e o buffer em que eles são desenhados
+  const std::array<bool, 2> modo{m_instanced, m_niveisDeDetalhe};
+  if(modo != m_modoAnterior){
+    m_modoAnterior = modo;
+    m_tudoAlterado = true;
+  }
 
-      if(dice.translation.y >= 1.5f) {
-        dice.movimentoDado.y = false;
-        velocidadeAngularAleatoria(dice);
-        velocidadeDirecionalAleatoria(dice);
-      }
-      else if (dice.translation.y <= -1.5f) {
-        dice.movimentoDado.y = true;
-        velocidadeAngularAleatoria(dice);
-        velocidadeDirecionalAleatoria(dice);
-      }
-      
-      //ir pra direita
-      if(dice.movimentoDado.x) {
-        dice.translation.x += dice.velocidadeDirecional.x; 
-      }
-      //ir pra esquerda
-      else{
-        dice.translation.x -= dice.velocidadeDirecional.x;
-      }
-      //ir pra cima
-      if(dice.movimentoDado.y) {
-        dice.translation.y += dice.velocidadeDirecional.y; 
+  //só os dados acordados e os que a simulação marcou como alterados têm a matriz recalculada
+  coletarAlterados();
+  atualizarAlterados(m_simulacao.alpha());
+
+  //medimos apenas o custo de CPU para submeter os desenhos, que é o que muda entre os dois modos
+  abcg::ElapsedTimer tempoSubmissao;
+  m_drawCalls = 0;
+  m_triangulos = 0;
+  const auto matrizes{agruparPorNivel()};
+  if(m_instanced && m_instancedProgram != 0){
+    desenharInstanciado(matrizes);
+  }
+  else{
+    desenharIndividualmente(matrizes);
+  }
+  m_tempoSubmissao = tempoSubmissao.elapsed();
+  m_tudoAlterado = false;
+}
+
+//monta m_faixas, em ordem e sem sobreposição: os acordados [0, acordados()) e os índices que a simulação
+//marcou desde o último quadro, ou todos os dados se algo mudou para todos (escala, tela ou modo de desenho)
+void Dices::coletarAlterados(){
+  const auto quantidade{m_simulacao.size()};
+  //dados que saíram do fim da mesa deixam de contar nos grupos
+  for(auto index{quantidade}; index < m_grupoDoDado.size(); ++index){
+    if(m_grupoDoDado[index] != semGrupo) --m_dadosNoGrupo[m_grupoDoDado[index]];
+  }
+  m_modelMatrices.resize(quantidade);
+  m_faixas.clear();
+
+  if(m_tudoAlterado || m_simulacao.tudoAlterado()){
+    m_tudoAlterado = true;
+    m_grupoDoDado.clear();
+    m_dadosNoGrupo.assign(m_mesh->m_niveis.size(), 0);
+    m_faixas.push_back({0, quantidade});
+  }
+  else{
+    const auto acordados{m_simulacao.acordados()};
+    if(acordados > 0) m_faixas.push_back({0, acordados});
+    const auto alterados{m_simulacao.alterados()};
+    m_alterados.assign(alterados.begin(), alterados.end());
+    std::sort(m_alterados.begin(), m_alterados.end());
+    for(const auto index : m_alterados){
+      if(index < acordados || index >= quantidade) continue;
+      if(!m_faixas.empty() && m_faixas.back().fim >= index){
+        m_faixas.back().fim = std::max<std::size_t>(m_faixas.back().fim, index + 1);
       }
-      //ir pra baixo
       else{
-        dice.translation.y -= dice.velocidadeDirecional.y;
+        m_faixas.push_back({index, index + 1});
       }
+    }
+  }
+  m_simulacao.limparAlterados();
+}
 
-      ////fmt::print("q: {} dice.translation: {} {}\n", dice.quadros, dice.translation.x, dice.translation.y);
-      
-      //podemos finalizar o giro do dado e parar num número aleatório
-      if(dice.quadros > dice.maxQuadros){
-        pousarDado(dice);
-      }
+//recalcula as matrizes e os grupos dos dados de m_faixas, mantendo a contagem de dados por grupo
+void Dices::atualizarAlterados(float alpha){
+  m_grupoDoDado.resize(m_modelMatrices.size(), semGrupo);
+  m_dadosAtualizados = 0;
+  for(const auto &faixa : m_faixas){
+    for(auto index{faixa.inicio}; index < faixa.fim; ++index){
+      atualizarMatrizModelo(index, alpha);
+      const auto grupo{static_cast<std::uint8_t>(escolherNivel(m_modelMatrices[index]))};
+      if(m_grupoDoDado[index] != semGrupo) --m_dadosNoGrupo[m_grupoDoDado[index]];
+      ++m_dadosNoGrupo[grupo];
+      m_grupoDoDado[index] = grupo;
     }
+    m_dadosAtualizados += faixa.fim - faixa.inicio;
+  }
+}
 
-    // angulo (em radianos) é incrementado se houver alguma rotação ativa
-    if(dice.m_rotation.x || dice.m_rotation.y ||dice.m_rotation.z){
-      //ajuste de velocidade de rotação, necessário para conseguirmos pausar
-      dice.myTime = deltaTime;
-      
-      //incrementa ângulo de {x,y,z} se rotação em torno do eixo {x,y,z} estiver ativa
-      if(dice.m_rotation.x)
-        dice.m_angle.x = glm::wrapAngle(dice.m_angle.x + dice.velocidadeAngular.x * dice.myTime);
+//os grupos ficam contíguos e na ordem dos níveis. Com a projeção sem perspectiva e
+//todos os dados na mesma escala, em geral um só grupo está em uso: m_modelMatrices já serve e os buffers
+//recebem só as faixas alteradas. Com mais de um grupo, as matrizes são reordenadas por contagem e reenviadas
+std::span<const glm::mat4> Dices::agruparPorNivel(){
+  const auto quantidadeDeGrupos{m_dadosNoGrupo.size()};
+  m_inicioDoNivel.assign(quantidadeDeGrupos + 1, 0);
+  std::size_t gruposEmUso{0};
+  std::size_t grupoUnico{espalhados};
+  for(std::size_t grupo{0}; grupo < quantidadeDeGrupos; ++grupo){
+    m_inicioDoNivel[grupo + 1] = m_inicioDoNivel[grupo] + m_dadosNoGrupo[grupo];
+    if(m_dadosNoGrupo[grupo] > 0){
+      ++gruposEmUso;
+      grupoUnico = grupo;
+    }
+  }
+
+  //o buffer do grupo só está em dia se o mesmo grupo tinha todos os dados no último quadro
+  if(gruposEmUso > 1 || grupoUnico != m_grupoUnico){
+    m_faixas.assign(1, {0, m_modelMatrices.size()});
+  }
+  m_grupoUnico = gruposEmUso > 1 ? espalhados : grupoUnico;
+  if(gruposEmUso <= 1) return m_modelMatrices;
 
-      if(dice.m_rotation.y)
-        dice.m_angle.y = glm::wrapAngle(dice.m_angle.y + dice.velocidadeAngular.y * dice.myTime);
+  auto proximo{m_inicioDoNivel};
+  m_matrizesPorNivel.resize(m_modelMatrices.size());
+  for(std::size_t index{0}; index < m_modelMatrices.size(); ++index){
+    m_matrizesPorNivel[proximo[m_grupoDoDado[index]]++] = m_modelMatrices[index];
+  }
+  return m_matrizesPorNivel;
+}
 
-      if(dice.m_rotation.z)
-        dice.m_angle.z = glm::wrapAngle(dice.m_angle.z + dice.velocidadeAngular.z * dice.myTime);
+//um glDrawElements por dado, com a matriz de modelo atualizada antes de cada chamada. Neste modo o custo
+//continua proporcional a todos os dados, parados ou não: cada um é uma chamada de desenho
+void Dices::desenharIndividualmente(std::span<const glm::mat4> matrizes){
+  abcg::glUseProgram(m_program); //usar shaders
+  abcg::glBindVertexArray(m_mesh->m_VAO); //todos os dados usam o mesmo vao
+
+  for(std::size_t nivel{0}; nivel < m_mesh->m_niveis.size(); ++nivel){
+    const auto &malha{m_mesh->m_niveis[nivel]};
+    for(auto index{m_inicioDoNivel[nivel]}; index < m_inicioDoNivel[nivel + 1]; ++index){
+      // atualizar a matriz de modelo (rotação e translação) dentro do vertex shader
+      m_modelMatrixUniform.set(matrizes[index]);
+
+      // Draw triangles
+      abcg::glDrawElements(GL_TRIANGLES, malha.m_indexCount, m_mesh->m_indexType,
+                          malha.m_offset);
+      ++m_drawCalls;
+      m_triangulos += malha.m_indexCount / 3;
     }
-    ////fmt::print("angle: {} {} {}\n", dice.m_angle.x, dice.m_angle.y, dice.m_angle.z);
+  }
+  abcg::glBindVertexArray(0);
+  abcg::glUseProgram(0);
+}
 
+//uma chamada por nível de detalhe em uso: a matriz de modelo de cada dado vai num buffer de atributos por instância,
+//agrupada com as dos outros dados do mesmo nível. O buffer é mantido entre quadros e só recebe as faixas alteradas,
+//escritas direto na região do anel que a GPU já terminou de ler
+void Dices::desenharInstanciado(std::span<const glm::mat4> matrizes){
+  if(matrizes.empty()) return;
+
+  m_regiaoDasInstancias = m_instancias.enviar(matrizes, std::span<const FaixaAlterada>{m_faixas});
+
+  abcg::glUseProgram(m_instancedProgram);
+  abcg::glBindVertexArray(m_instanceVAO);
+  for(std::size_t nivel{0}; nivel < m_mesh->m_niveis.size(); ++nivel){
+    const auto instancias{m_inicioDoNivel[nivel + 1] - m_inicioDoNivel[nivel]};
+    if(instancias == 0) continue;
+    //sem glDrawElementsInstancedBaseInstance no OpenGL ES 3.0: o grupo do nível é escolhido pelo deslocamento dos atributos
+    apontarMatrizesDeInstancia(m_inicioDoNivel[nivel]);
+    const auto &malha{m_mesh->m_niveis[nivel]};
+    abcg::glDrawElementsInstanced(GL_TRIANGLES, malha.m_indexCount, m_mesh->m_indexType,
+                                  malha.m_offset, static_cast<GLsizei>(instancias));
+    ++m_drawCalls;
+    m_triangulos += static_cast<long long>(malha.m_indexCount / 3) * static_cast<long long>(instancias);
+  }
+  m_instancias.desenhado();
+  abcg::glBindVertexArray(0);
+  abcg::glUseProgram(0);
+}
 
-    // atualizar variavel do angulo de rotação e posição de translação dentro do vertex shader
-    const GLint rotationXLoc{abcg::glGetUniformLocation(m_program, "rotationX")};
-    abcg::glUniform1f(rotationXLoc, dice.m_angle.x);
-    const GLint rotationYLoc{abcg::glGetUniformLocation(m_program, "rotationY")};
-    abcg::glUniform1f(rotationYLoc, dice.m_angle.y);
-    const GLint rotationZLoc{abcg::glGetUniformLocation(m_program, "rotationZ")};
-    abcg::glUniform1f(rotationZLoc, dice.m_angle.z);
-    const GLint translationLoc{abcg::glGetUniformLocation(m_program, "translation")};
-    abcg::glUniform3fv(translationLoc, 1, &dice.translation.x);
+DiceMesh::~DiceMesh(){
+  abcg::glDeleteBuffers(1, &m_EBO);
+  abcg::glDeleteBuffers(1, &m_VBO);
+  abcg::glDeleteVertexArrays(1, &m_VAO);
+}
 
-    // Draw triangles
-    abcg::glDrawElements(GL_TRIANGLES, m_verticesToDraw, GL_UNSIGNED_INT,
-                        nullptr);
+//formato do VerticeCompacto no VBO ligado: posição em três shorts normalizados (o shader recebe vec3 em [-1,1])
+//e material em um byte sem normalização (o shader recebe o id como float: 0.0 preto, 1.0 branco)
+static void configurarAtributosDoVertice(const abcg::ProgramReflection &reflection){
+  const GLint positionAttribute{reflection.attributeLocation("inPosition")}; //layout(location = _)
+  if (positionAttribute >= 0) {
+    abcg::glEnableVertexAttribArray(positionAttribute);
+    abcg::glVertexAttribPointer(positionAttribute, 3, GL_SHORT, GL_TRUE,
+                                sizeof(VerticeCompacto),
+                                reinterpret_cast<void*>(offsetof(VerticeCompacto, posicao)));
+  }
 
-    abcg::glBindVertexArray(0);
+  const GLint materialAttribute{reflection.attributeLocation("inMaterial")};
+  if (materialAttribute >= 0) {
+    abcg::glEnableVertexAttribArray(materialAttribute);
+    abcg::glVertexAttribPointer(materialAttribute, 1, GL_UNSIGNED_BYTE, GL_FALSE,
+                                sizeof(VerticeCompacto),
+                                reinterpret_cast<void*>(offsetof(VerticeCompacto, material)));
   }
-  abcg::glUseProgram(0);
 }
 
-//função para começar o dado numa posição e número aleatório, além de inicializar algumas outras variáveis necessárias
-Dices::Dice Dices::inicializarDado() {
-  Dice dice;
+//envia o modelo para a GPU uma única vez; o resultado é compartilhado por todos os dados.
+//vértices e índices só são lidos durante a chamada e podem apontar para um arquivo mapeado.
+//os índices chegam como bytes, com indexSize (2 ou 4) bytes cada; lods divide os índices em níveis de detalhe
+//(vazio = um só nível com todos os índices)
+static std::shared_ptr<const DiceMesh> criarMalha(const abcg::ProgramReflection &reflection,
+                                                  std::span<const VerticeCompacto> vertices,
+                                                  std::span<const std::byte> indices, std::size_t indexSize,
+                                                  std::span<const abcg::MeshLod> lods) {
+  auto mesh{std::make_shared<DiceMesh>()};
+  for(const auto &vertice : vertices){
+    const glm::vec3 posicao{vertice.posicao[0], vertice.posicao[1], vertice.posicao[2]};
+    mesh->m_raio = std::max(mesh->m_raio, glm::length(posicao / 32767.0f));
+  }
+  mesh->m_indexType = indexSize == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  if(lods.empty()){
+    mesh->m_niveis.push_back({static_cast<GLsizei>(indices.size() / indexSize), nullptr, 0.0f});
+  }
+  for(const auto &lod : lods){
+    mesh->m_niveis.push_back({static_cast<GLsizei>(lod.indexCount),
+                              reinterpret_cast<const void*>(std::uintptr_t{lod.firstIndex} * indexSize),
+                              static_cast<float>(lod.error)});
+  }
+
+  mesh->m_bytes = vertices.size_bytes() + indices.size_bytes();
 
   // Generate VBO
-  abcg::glGenBuffers(1, &dice.m_VBO);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, dice.m_VBO);
-  abcg::glBufferData(GL_ARRAY_BUFFER, sizeof(m_vertices[0]) * m_vertices.size(),
-                     m_vertices.data(), GL_STATIC_DRAW);
+  abcg::glGenBuffers(1, &mesh->m_VBO);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, mesh->m_VBO);
+  abcg::glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size_bytes()),
+                     vertices.data(), GL_STATIC_DRAW);
   abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
-  ////fmt::print("vbo: {}\n", dice.m_VBO);
 
   // Generate EBO
-  abcg::glGenBuffers(1, &dice.m_EBO);
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, dice.m_EBO);
+  abcg::glGenBuffers(1, &mesh->m_EBO);
+  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->m_EBO);
   abcg::glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                     sizeof(m_indices[0]) * m_indices.size(), m_indices.data(),
+                     static_cast<GLsizeiptr>(indices.size()), indices.data(),
                      GL_STATIC_DRAW);
   abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-  ////fmt::print("ebo: {}\n", dice.m_EBO);
 
   // Create VAO
-  abcg::glGenVertexArrays(1, &dice.m_VAO);
+  abcg::glGenVertexArrays(1, &mesh->m_VAO);
 
   // Bind vertex attributes to current VAO
-  abcg::glBindVertexArray(dice.m_VAO);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, dice.m_VBO);
-  ////fmt::print("vAo: {}\n", dice.m_VAO);
+  abcg::glBindVertexArray(mesh->m_VAO);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, mesh->m_VBO);
 
   // Bind vertex attributes
-  GLint positionAttribute{abcg::glGetAttribLocation(m_program, "inPosition")}; //layout(location = _)
-  if (positionAttribute >= 0) {
-    abcg::glEnableVertexAttribArray(positionAttribute);
-    abcg::glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, GL_FALSE,
-                                sizeof(Vertex), nullptr);
-  }
+  configurarAtributosDoVertice(reflection);
 
-  //aqui a gente passa a cor do vértice já pronta para o shader
-  const GLint colorAttribute{abcg::glGetAttribLocation(m_program, "inColor")};
-  if (colorAttribute >= 0) {
-    abcg::glEnableVertexAttribArray(colorAttribute);
-    GLsizei offset{sizeof(glm::vec3)};
-    abcg::glVertexAttribPointer(colorAttribute, 3, GL_FLOAT, GL_FALSE,
-                                sizeof(Vertex),
-                                reinterpret_cast<void*>(offset));
-  }
-
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, dice.m_EBO);
+  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->m_EBO);
 
   // End of binding to current VAO
   abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
   abcg::glBindVertexArray(0);
-  
-  //estado inicial de algumas variáveis
-  dice.m_rotation = {0, 0, 0};  
-  dice.velocidadeAngular = {0.0f, 0.0f, 0.0f};
-  dice.myTime = 0.0f;
-  dice.quadros=0;
-
-  std::uniform_real_distribution<float> fdist(-1.5f,1.5f);
-  dice.translation = {fdist(m_randomEngine),fdist(m_randomEngine),0.0f};
-  pousarDado(dice); //começar num numero aleatorio
-
-  return dice;
+
+  return mesh;
 }
 
-void Dices::jogarDado(Dice &dice){
-  tempoGirandoAleatorio(dice);
-  velocidadeAngularAleatoria(dice);
-  velocidadeDirecionalAleatoria(dice);
-  dice.dadoGirando = true;
+MeshAsset MeshAsset::enviar(const abcg::ProgramReflection &reflection, MalhaCarregada dados, bool manterNaCpu){
+  MeshAsset asset;
+  asset.m_gpu = criarMalha(reflection, dados.vertices(), dados.indices(), dados.tamanhoDoIndice(), dados.niveis());
+  if(manterNaCpu) asset.m_cpu = std::make_shared<const MalhaCarregada>(std::move(dados));
+  return asset;
 }
 
-//função para fazer o dado parar numa das faces retas aleatoriamente
-void Dices::pousarDado(Dice &dice) {
-  auto seed{std::chrono::steady_clock::now().time_since_epoch().count()};
-  m_randomEngine.seed(seed);
-  //reinicialização de variáveis para podermos parar o dado e jogar novamente
-  dice.quadros = 0;
-  dice.dadoGirando = false;
-  dice.m_rotation = {0,0,0};
-
-  //fmt::print("posicao final: {} {}\n", dice.translation.x, dice.translation.y);
-
-  std::uniform_int_distribution<int> idist(1,6);
-  const int numeroDoDado = idist(m_randomEngine);
-  //fmt::print("numeroDoDado: {}\n", numeroDoDado);
-  dice.m_angle.x = glm::radians(angulosRetos[numeroDoDado].x);
-  dice.m_angle.y = glm::radians(angulosRetos[numeroDoDado].y);
+RelatorioDeMemoria MeshAsset::memoria() const noexcept{
+  RelatorioDeMemoria relatorio;
+  if(m_gpu) relatorio.gpu = m_gpu->m_bytes;
+  if(m_cpu && m_cpu->cache.isValid()){
+    relatorio.mapeada = m_cpu->cache.vertexBytes().size() + m_cpu->cache.indexBytes().size() +
+                        m_cpu->cache.lods().size_bytes();
+  }
+  if(m_cpu){
+    const auto &malha{m_cpu->malha};
+    relatorio.cpu = malha.vertices.capacity() * sizeof(VerticeCompacto) + malha.indices.capacity() +
+                    malha.niveis.capacity() * sizeof(abcg::MeshLod);
+  }
+  return relatorio;
 }
 
-//função para definir tempo de giro do dado, algo entre 2 e 5 segundos 
-void Dices::tempoGirandoAleatorio(Dice &dice){
-  const float FPS = ImGui::GetIO().Framerate;
-  //distribuição aleatória para definir tempo de giro do dado, algo entre 2 e 5 segundos 
-  std::uniform_int_distribution<int> idist((int)FPS * 2, (int)FPS * 5);
-  dice.maxQuadros = idist(m_randomEngine); //número máximo de quadros/vezes que o dado irá girar
-  //fmt::print("maxQuadros: {}\n", dice.maxQuadros);
+//orientação equivalente a girar em x, depois em y, depois em z
+static glm::quat orientacao(const glm::vec3 &angle){
+  return glm::angleAxis(angle.z, glm::vec3{0.0f, 0.0f, 1.0f}) *
+         glm::angleAxis(angle.y, glm::vec3{0.0f, 1.0f, 0.0f}) *
+         glm::angleAxis(angle.x, glm::vec3{1.0f, 0.0f, 0.0f});
 }
 
-//atualiza as velocidades de cada um dos eixos de forma aleatória
-void Dices::velocidadeAngularAleatoria(Dice &dice){
-  //distribuição aleatória entre 0 e 2, para girar somente 1 eixo
-  dice.m_rotation = {0, 0, 0};
-  std::uniform_int_distribution<int> idist(0,2);
-  dice.m_rotation[idist(m_randomEngine)] = 1;
-  ////fmt::print("m_rotation.x: {} m_rotation.y: {} m_rotation.z: {}\n", dice.m_rotation.x, dice.m_rotation.y, dice.m_rotation.z);
-
-  const float FPS = ImGui::GetIO().Framerate; //(para calcular os segundos precisamos do número inteiro de FPS)
-  //fmt::print("FPS: {}\n",FPS);
-
-  //distribuição aleatória de velocidade angular, para girar em cada eixo numa velocidade
-  std::uniform_real_distribution<float> fdist(FPS * 4, FPS * 8);
-  dice.velocidadeAngular = {glm::radians(fdist(m_randomEngine))
-                      ,glm::radians(fdist(m_randomEngine))
-                      ,glm::radians(fdist(m_randomEngine))};
-  ////fmt::print("velocidadeAngular.x: {} velocidadeAngular.y: {} velocidadeAngular.z: {}\n", dice.velocidadeAngular.x, dice.velocidadeAngular.y, dice.velocidadeAngular.z);
+//compõe na CPU a matriz de modelo do dado, interpolando entre o passo anterior e o atual (alpha em [0,1]).
+//assim o vertex shader faz uma única multiplicação por vértice, sem seno/cosseno
+void Dices::atualizarMatrizModelo(std::size_t index, float alpha){
+  const auto &e{m_simulacao.estado()};
+  const glm::vec3 translation{glm::mix(e.posXAnterior[index], e.posX[index], alpha),
+                              glm::mix(e.posYAnterior[index], e.posY[index], alpha), 0.0f};
+  const glm::quat rotation{glm::slerp(orientacao({e.angXAnterior[index], e.angYAnterior[index], e.angZAnterior[index]}),
+                                      orientacao({e.angX[index], e.angY[index], e.angZ[index]}), alpha)};
+  m_modelMatrices[index] = glm::translate(glm::mat4{1.0f}, translation) * glm::mat4_cast(rotation) *
+                           glm::scale(glm::mat4{1.0f}, glm::vec3{m_simulacao.escala()});
 }
 
-//recebe uma das dimensões da janela e retorna uma fração aleatória do seu tamanho
-void Dices::velocidadeDirecionalAleatoria(Dice &dice){
-  //distribuição aleatória de velocidade, para andar em cada eixo numa velocidade
-  std::uniform_real_distribution<float> fdist(m_deltaTime / 200.0f, m_deltaTime / 100.0f);
-  dice.velocidadeDirecional.x = fdist(m_randomEngine) * m_viewportWidth;
-  dice.velocidadeDirecional.y = fdist(m_randomEngine) * m_viewportHeight;
-  //fmt::print("m_deltaTime: {}\n", m_deltaTime);
-  ////fmt::print("velocidadeDirecional.x: {} velocidadeDirecional.y: {}\n", dice.velocidadeDirecional.x, dice.velocidadeDirecional.y);
+//VAO do modo instanciado: reaproveita o VBO/EBO da malha compartilhada. A matriz de modelo de cada dado,
+//avançando uma vez por instância, é apontada a cada quadro para a região de m_instancias daquele quadro
+void Dices::criarBufferDeInstancias() {
+  abcg::glGenVertexArrays(1, &m_instanceVAO);
+  abcg::glBindVertexArray(m_instanceVAO);
+
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_mesh->m_VBO);
+  configurarAtributosDoVertice(m_instancedReflection);
+
+  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_mesh->m_EBO);
+
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+  abcg::glBindVertexArray(0);
 }
 
-//a função retorna true se o dado passado como parâmetro está colidindo com algum outro e deveria voltar pra outra direção
-void Dices::checkCollisions(Dice &current_dice) {
-  // Check collision between ship and asteroids
-  for(auto &dice : m_dices) {
-    if(&dice != &current_dice)
-    {
-      const auto distance{
-          glm::distance(current_dice.translation, dice.translation)};
-
-      if (distance < 1.2f) {
-        if(!current_dice.dadoColidindo) {
-          current_dice.dadoColidindo = true;
-          //dice.dadoColidindo = true;
-          current_dice.movimentoDado.x = !current_dice.movimentoDado.x;
-          current_dice.movimentoDado.y = !current_dice.movimentoDado.y;
-          //jogarDado(current_dice);
-        }
-        return;
-      }
-    }
+//aponta inModelMatrix do VAO instanciado (que deve estar ligado) para a região de m_instancias escrita
+//neste quadro, começando na matriz primeiraInstancia
+void Dices::apontarMatrizesDeInstancia(std::size_t primeiraInstancia) {
+  if (m_modelMatrixAttribute < 0) return;
+
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_instancias.buffer());
+  //cada coluna da matriz é um atributo vec4 consecutivo
+  for(GLuint column{0}; column < 4; ++column){
+    const GLuint location{static_cast<GLuint>(m_modelMatrixAttribute) + column};
+    abcg::glEnableVertexAttribArray(location);
+    abcg::glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE,
+                                sizeof(glm::mat4),
+                                reinterpret_cast<void*>(static_cast<std::size_t>(m_regiaoDasInstancias) +
+                                                        sizeof(glm::mat4) * primeiraInstancia +
+                                                        sizeof(glm::vec4) * column));
+    abcg::glVertexAttribDivisor(location, 1);
   }
-  current_dice.dadoColidindo = false;
-  return;
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void Dices::terminateGL(){
-  for(auto dice : m_dices){
-    abcg::glDeleteBuffers(1, &dice.m_EBO);
-    abcg::glDeleteBuffers(1, &dice.m_VBO);
-    abcg::glDeleteVertexArrays(1, &dice.m_VAO);
-    //fmt::print("Dice terminated.\n");
-  }
+  //a malha é liberada quando a última referência a ela desaparece
+  m_mesh.reset();
+
+  m_instancias.terminateGL();
+  abcg::glDeleteVertexArrays(1, &m_instanceVAO);
+  m_instanceVAO = 0;
 }
\ No newline at end of file
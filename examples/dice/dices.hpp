@@ -2,79 +2,147 @@
 #define DICES_HPP_
 
 #include "abcg.hpp"
-#include <random>
+#include "faixas.hpp"
+#include "model.hpp"
+#include "simulation.hpp"
+#include <array>
+#include <limits>
+#include <memory>
 #include <list>
+#include <span>
 
 class OpenGLWindow;
 
-//atributos que definem um vértice: posição 3D, cor e operador == pra verificar se um vértice é igual a outro
-struct Vertex {
-  glm::vec3 position;
-  glm::vec3 color;
+//buffers do modelo na GPU (VBO, EBO e VAO), compartilhados por todos os dados.
+//a malha é enviada uma única vez e liberada quando a última referência a ela desaparece
+struct DiceMesh {
+  GLuint m_VAO{};
+  GLuint m_VBO{};
+  GLuint m_EBO{};
+  GLenum m_indexType{GL_UNSIGNED_INT}; //GL_UNSIGNED_SHORT ou GL_UNSIGNED_INT, conforme o tamanho dos índices
 
-  bool operator==(const Vertex& other) const {
-    return position == other.position;
-  }
+  //trecho do EBO desenhado em cada nível de detalhe, do completo ao mais simples
+  struct Nivel {
+    GLsizei m_indexCount{}; //quantidade de índices processada por glDrawElements
+    const void *m_offset{}; //deslocamento em bytes do primeiro índice no EBO
+    float m_erro{}; //distância máxima dos vértices do nível aos planos dos triângulos completos, em unidades do modelo
+  };
+  std::vector<Nivel> m_niveis;
+  float m_raio{}; //raio da esfera centrada na origem que envolve a malha, em unidades do modelo
+  std::size_t m_bytes{}; //tamanho do VBO e do EBO
+
+  DiceMesh() = default;
+  DiceMesh(const DiceMesh&) = delete;
+  DiceMesh& operator=(const DiceMesh&) = delete;
+  ~DiceMesh();
+};
+
+//memória ocupada por uma malha, em bytes
+struct RelatorioDeMemoria {
+  std::size_t cpu{}; //arranjos alocados no processo
+  std::size_t mapeada{}; //trecho do arquivo .mesh mapeado em memória
+  std::size_t gpu{}; //buffers na GPU
+};
+
+//malha como fica no abcg::AssetCache: os buffers na GPU, compartilhados por todos que a desenham, e os arranjos
+//do lado da CPU só se alguém ainda precisar da geometria (colisão com a malha ou seleção com o mouse, por exemplo).
+//sem eles, depois do envio nenhuma cópia dos vértices e índices fica na memória do processo
+class MeshAsset {
+  public:
+    //envia a malha à GPU, com os atributos de vértice de reflection. Os dados são descartados ao fim da chamada
+    //(e, se vierem do .mesh, o arquivo deixa de ser mapeado), a menos que manterNaCpu seja true
+    [[nodiscard]] static MeshAsset enviar(const abcg::ProgramReflection &reflection, MalhaCarregada dados,
+                                          bool manterNaCpu = false);
+
+    [[nodiscard]] const std::shared_ptr<const DiceMesh> &gpu() const noexcept { return m_gpu; }
+    //vértices, índices e níveis de detalhe; nulo se foram descartados depois do envio
+    [[nodiscard]] const MalhaCarregada *cpu() const noexcept { return m_cpu.get(); }
+    [[nodiscard]] RelatorioDeMemoria memoria() const noexcept;
+
+  private:
+    std::shared_ptr<const DiceMesh> m_gpu;
+    std::shared_ptr<const MalhaCarregada> m_cpu;
 };
 
 class Dices {
   public:
-    void initializeGL(GLuint program, int quantity, std::vector<Vertex>, std::vector<GLuint>,int);
-    void paintGL(int m_viewportWidth, int m_viewportHeight, float deltaTime);
+    //mesh já está na GPU (MeshAsset::enviar) e pode ser compartilhada com outros Dices
+    void initializeGL(GLuint program, GLuint instancedProgram, int quantity, std::shared_ptr<const DiceMesh> mesh);
+    //troca a malha e os programas sem mexer nos dados da mesa
+    void usarMalha(GLuint program, GLuint instancedProgram, std::shared_ptr<const DiceMesh> mesh);
+    //muda a quantidade de dados mantendo os que já existem; malha, programas e buffers da GPU não mudam
+    void resize(int quantity);
+    //tamanho dos dados na mesa (ver DiceSimulation::definirEscala); o jogo usa sempre 1
+    void definirEscala(float escala) { m_simulacao.definirEscala(escala); }
+    //um dado entra ou sai da mesa sem mexer nos outros; o handle vale até o dado sair ou a mesa ser recriada
+    DiceHandle adicionarDado();
+    bool removerDado(DiceHandle dado);
+    void jogarDados();
+    void resizeGL(int width, int height);
+    void update(double deltaTime);
+    void paintGL();
+    [[nodiscard]] std::size_t quantidade() const { return m_simulacao.size(); }
     void terminateGL();
 
   private:
     friend OpenGLWindow;
 
     GLuint m_program{};
-    int m_verticesToDraw{}; //quantidade de vértices do VBO que será processada pela função de renderização, glDrawElements
-    double m_deltaTime{};
-    int m_viewportWidth{};
-    int m_viewportHeight{};
-
-    std::vector<Vertex> m_vertices; //arranjo de vértices lido do arquivo OBJ que será enviado ao VBO
-    std::vector<GLuint> m_indices; //arranjo de indices lido do arquivo OBJ que será enviado ao EBO
-
-    struct Dice {
-      GLuint m_VAO{};
-      GLuint m_VBO{};
-      GLuint m_EBO{};
-
-      glm::vec3 m_angle{}; // ângulo de rotação que será enviado à variável uniforme do vertex shader.
-      glm::ivec3 m_rotation{}; // nos ajuda a decidir qual a direção da rotação
-      glm::vec3 velocidadeAngular{}; //indica quantos graus/rad o dado deve girar por unidade de tempo, em cada um dos eixos x,y,z
-      glm::vec2 velocidadeDirecional{};
-      glm::vec3 translation{}; //indica a posição transladada do dado
-      glm::bvec2 movimentoDado{true, true}; //false = irá pra esquerda/baixo, true = irá pra direita/cima
-
-      float myTime{}; //auxiliar para conseguirmos não girar o tempo todo
-      bool dadoGirando{false}; //indica se o dado deve estar girando 
-      bool dadoColidindo{false};
-      int quadros; //contador de quadros, auxilia no tempo que o dado fica girando
-      int maxQuadros;
-    };
-    //lista de ângulos cuja face do dado fica virada para a tela. Poderia ser maior, mas o resultado final seria pouco diferente.
-    std::array<glm::vec3, 7> angulosRetos{
-      glm::vec3{0.0f,0.0f,0.0f}, //0 apenas pra manter o numero do dado igual ao numero do indice
-      glm::vec3{125.0f,120.0f,45.0f}, //1
-      glm::vec3{345.0f,170.0f,15.0f}, //2
-      glm::vec3{75.0f,190.0f,13.0f}, //3
-      glm::vec3{75.0f,20.0f,77.0f},//4
-      glm::vec3{347.0f,342.0f,75.0f}, //5 
-      glm::vec3{105.0f,300.0f,45.0f} //6
-    };
-
-    std::vector<Dice> m_dices;
-
-    std::default_random_engine m_randomEngine; //gerador de números pseudo-aleatórios
-
-    Dices::Dice inicializarDado();
-    void jogarDado(Dice &); 
-    void pousarDado(Dice&); 
-    void velocidadeAngularAleatoria(Dice&); 
-    void velocidadeDirecionalAleatoria(Dice&); 
-    void tempoGirandoAleatorio(Dice&);
-    void checkCollisions(Dice&);
+    GLuint m_instancedProgram{}; //shaders do modo instanciado (atributos por instância no lugar dos uniformes)
+    abcg::ProgramReflection m_reflection; //uniformes e atributos ativos de m_program
+    abcg::ProgramReflection m_instancedReflection; //atributos ativos de m_instancedProgram
+    abcg::Uniform<glm::mat4> m_modelMatrixUniform;
+    GLint m_modelMatrixAttribute{-1}; //inModelMatrix de m_instancedProgram (a primeira das quatro colunas)
+
+    DiceSimulation m_simulacao; //lançamento, movimento, colisões e pouso; aqui só desenhamos o estado dela
+
+    std::shared_ptr<const DiceMesh> m_mesh; //malha compartilhada por todos os dados
+
+    //matriz de modelo de cada dado, pelo índice na simulação. Só as dos dados acordados são interpoladas a cada
+    //quadro; as dos que dormem são recalculadas quando a simulação avisa que mudaram
+    std::vector<glm::mat4> m_modelMatrices;
+    //grupo de cada dado (nível de detalhe) e quantos dados há em cada grupo
+    static constexpr std::uint8_t semGrupo{std::numeric_limits<std::uint8_t>::max()}; //dado ainda não agrupado
+    std::vector<std::uint8_t> m_grupoDoDado;
+    std::vector<std::size_t> m_dadosNoGrupo;
+    //faixas de índices cujas matrizes foram recalculadas neste quadro e precisam ser reenviadas
+    std::vector<FaixaAlterada> m_faixas;
+    std::vector<std::uint32_t> m_alterados; //cópia ordenada de DiceSimulation::alterados()
+    bool m_tudoAlterado{true}; //recalcular e reenviar todos os dados no próximo quadro
+    //grupo de todos os dados no último quadro, ou espalhados se havia mais de um grupo em uso
+    static constexpr std::size_t espalhados{std::numeric_limits<std::size_t>::max()};
+    std::size_t m_grupoUnico{espalhados};
+    //as matrizes agrupadas por nível de detalhe e onde começa cada grupo (uma entrada a mais no fim). Com um só grupo em uso, m_modelMatrices já está
+    //agrupada e é usada no lugar desta
+    std::vector<glm::mat4> m_matrizesPorNivel;
+    std::vector<std::size_t> m_inicioDoNivel;
+    BufferDeInstancias<glm::mat4> m_instancias; //matrizes dos dados desenhados com malha, mantidas entre quadros
+    GLintptr m_regiaoDasInstancias{}; //deslocamento em bytes da região de m_instancias escrita neste quadro
+    GLuint m_instanceVAO{};
+
+    //true = um glDrawElementsInstanced por nível de detalhe, e o custo por quadro acompanha só os dados que se
+    //movem. false = um glDrawElements e um uniforme por dado, parado ou não, a cada quadro
+    bool m_instanced{true};
+    bool m_niveisDeDetalhe{true}; //false = todos os dados com a malha completa
+    int m_alturaDaTela{1}; //altura do viewport em pixels, para estimar o tamanho projetado dos dados
+    std::array<bool, 2> m_modoAnterior{}; //m_instanced e m_niveisDeDetalhe no último quadro
+    std::size_t m_dadosAtualizados{}; //dados cujas matrizes foram recalculadas no último quadro
+    int m_drawCalls{}; //chamadas de desenho emitidas no último quadro
+    long long m_triangulos{}; //triângulos enviados no último quadro
+    double m_tempoSubmissao{}; //tempo de CPU (s) gasto submetendo os desenhos no último quadro
+
+    //dados que podem entrar na mesa um a um, além da quantidade escolhida, antes que algum arranjo realoque
+    static constexpr std::size_t folgaParaAvulsos{256};
+    void reservar(std::size_t quantidade);
+    void criarBufferDeInstancias();
+    void apontarMatrizesDeInstancia(std::size_t primeiraInstancia);
+    [[nodiscard]] std::size_t escolherNivel(const glm::mat4 &modelMatrix) const;
+    void coletarAlterados();
+    void atualizarAlterados(float alpha);
+    [[nodiscard]] std::span<const glm::mat4> agruparPorNivel();
+    void atualizarMatrizModelo(std::size_t, float alpha);
+    void desenharIndividualmente(std::span<const glm::mat4> matrizes);
+    void desenharInstanciado(std::span<const glm::mat4> matrizes);
 };
 
 #endif
\ No newline at end of file
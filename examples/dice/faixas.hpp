@@ -0,0 +1,102 @@
+#ifndef FAIXAS_HPP_
+#define FAIXAS_HPP_
+
+#include "abcg.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+//elementos [inicio, fim) de um arranjo que mudaram desde o último quadro
+struct FaixaAlterada {
+  std::size_t inicio{};
+  std::size_t fim{};
+};
+
+//buffer de atributos por instância que guarda dados entre quadros, num anel de três regiões (abcg::RingBuffer):
+//a CPU escreve a região do quadro atual enquanto a GPU ainda lê as dos dois anteriores, sem esperar pelo driver.
+//cada região só recebe as faixas que mudaram desde a última vez que foi escrita, ou seja, as dos três últimos
+//quadros; com os dados acordados no começo do arranjo, em geral isso é uma única cópia contígua.
+//Anel só existe para que checks/instancias.cpp rode esta lógica sobre um anel na memória, sem contexto OpenGL
+template <typename T, typename Anel = abcg::RingBuffer>
+class BufferDeInstancias {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+  public:
+    static constexpr std::size_t regioes{3};
+
+    //copia para a próxima região as faixas alteradas (recortadas ao tamanho de dados) e as que ela perdeu nos
+    //quadros anteriores. Se dados não cabe na capacidade atual (em elementos), o anel é recriado com folga, para
+    //que entradas uma a uma não o recriem a cada quadro, e todas as regiões recebem tudo.
+    //retorna o deslocamento em bytes da região no buffer, a somar aos ponteiros dos atributos
+    GLintptr enviar(std::span<const T> dados, std::span<const FaixaAlterada> faixas) {
+      if(m_anel.buffer() == 0 || dados.size() > m_capacidade) {
+        m_capacidade = std::max({dados.size(), m_capacidade * 2, std::size_t{1}});
+        m_anel.create(static_cast<GLsizeiptr>(sizeof(T) * m_capacidade), regioes);
+        m_regiao = regioes - 1;
+        for(auto &pendentes : m_pendentes) pendentes.assign(1, {0, std::numeric_limits<std::size_t>::max()});
+      }
+      for(auto &pendentes : m_pendentes) pendentes.insert(pendentes.end(), faixas.begin(), faixas.end());
+
+      m_regiao = (m_regiao + 1) % regioes;
+      auto &pendentes{m_pendentes[m_regiao]};
+      juntar(pendentes, dados.size());
+
+      //descartar a região só vale se ela vai ser toda reescrita
+      const bool tudo{pendentes.size() == 1 && pendentes.front().inicio == 0 &&
+                      pendentes.front().fim == dados.size()};
+      auto *regiao{m_anel.map(tudo)};
+      for(const auto &faixa : pendentes) {
+        const auto inicio{sizeof(T) * faixa.inicio};
+        const auto bytes{sizeof(T) * (faixa.fim - faixa.inicio)};
+        std::memcpy(regiao + inicio, dados.data() + faixa.inicio, bytes);
+        m_anel.flush(static_cast<GLintptr>(inicio), static_cast<GLsizeiptr>(bytes));
+      }
+      pendentes.clear();
+      //se o driver perdeu o conteúdo do buffer enquanto estava mapeado, a região é reescrita inteira na próxima vez
+      if(!m_anel.unmap()) pendentes.assign(1, {0, std::numeric_limits<std::size_t>::max()});
+      return m_anel.regionOffset();
+    }
+
+    //chamar depois do último desenho que lê a região enviada neste quadro
+    void desenhado() { m_anel.fence(); }
+
+    void terminateGL() {
+      m_anel.destroy();
+      m_capacidade = 0;
+      for(auto &pendentes : m_pendentes) pendentes.clear();
+    }
+
+    [[nodiscard]] GLuint buffer() const noexcept { return m_anel.buffer(); }
+    [[nodiscard]] const Anel &anel() const noexcept { return m_anel; }
+
+  private:
+    Anel m_anel;
+    std::size_t m_capacidade{}; //elementos que cabem em cada região
+    std::size_t m_regiao{}; //região escrita no último quadro
+    //faixas que cada região ainda não recebeu
+    std::array<std::vector<FaixaAlterada>, regioes> m_pendentes;
+
+    //ordena as faixas, recorta ao tamanho e une as que se sobrepõem ou se tocam
+    static void juntar(std::vector<FaixaAlterada> &faixas, std::size_t tamanho) {
+      std::sort(faixas.begin(), faixas.end(),
+                [](const FaixaAlterada &a, const FaixaAlterada &b) { return a.inicio < b.inicio; });
+      std::size_t unidas{0};
+      for(const auto &faixa : faixas) {
+        const auto fim{std::min(faixa.fim, tamanho)};
+        if(faixa.inicio >= fim) continue;
+        if(unidas > 0 && faixas[unidas - 1].fim >= faixa.inicio) {
+          faixas[unidas - 1].fim = std::max(faixas[unidas - 1].fim, fim);
+        }
+        else {
+          faixas[unidas++] = {faixa.inicio, fim};
+        }
+      }
+      faixas.resize(unidas);
+    }
+};
+
+#endif
@@ -1,5 +1,8 @@
 #include <fmt/core.h>
 
+#include <string>
+#include <string_view>
+
 #include "abcg.hpp"
 #include "openglwindow.hpp"
 
@@ -11,6 +14,10 @@ int main(int argc, char **argv) {
     window->setOpenGLSettings({.samples = 4});
     window->setWindowSettings(
         {.width = 600, .height = 600, .showFPS = false, .showFullscreenButton = false, .title = "Dice 3D"});
+    //dice --benchmark [quadros]: mede 1, 100, 10000 e 100000 dados nos dois modos de desenho e termina
+    if(argc > 1 && std::string_view{argv[1]} == "--benchmark"){
+      window->medirDesempenho(argc > 2 ? std::stoi(argv[2]) : 300);
+    }
 
     app.run(std::move(window));
   } catch (const abcg::Exception &exception) {
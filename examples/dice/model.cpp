@@ -0,0 +1,250 @@
+#include "model.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cppitertools/itertools.hpp>
+#include <filesystem>
+#include <glm/geometric.hpp>
+#include <limits>
+
+#include "abcg_exception.hpp"
+#include "abcg_meshcache.hpp"
+#include "abcg_meshoptimizer.hpp"
+#include "abcg_meshsimplifier.hpp"
+#include "abcg_meshwinding.hpp"
+#include "abcg_objreader.hpp"
+#include "abcg_vertexwelder.hpp"
+
+namespace {
+//carregar e ler o arquivo .obj, armazenar vertices e indices em modelo.vertices e modelo.indices.
+void loadModelFromFile(std::string_view path, Modelo &modelo) {
+  const auto mesh{abcg::readObj(path)};
+
+  modelo.indices.clear();
+  modelo.indices.reserve(mesh.indices.size());
+
+  //tabela de vértices já vistos: cada vértice novo recebe o próximo índice, os repetidos reaproveitam o seu.
+  //reservada para o número de posições do arquivo, que é quase o número final de vértices
+  abcg::VertexWelder<Vertex> welder{mesh.positions.size() / 3};
+
+  // ler todos os triangulos e vertices
+  for (const auto offset : iter::range(mesh.indices.size())) { //122112 indices = numero de triangulos * 3
+    // Vertex position
+    const auto startIndex{3 * std::size_t{mesh.indices[offset]}}; //startIndex vai encontrar o indice exato de cada vertice
+    const float vx{mesh.positions[startIndex + 0]};
+    const float vy{mesh.positions[startIndex + 1]};
+    const float vz{mesh.positions[startIndex + 2]};
+
+    //são 40704 triangulos, dos quais 27264 brancos.
+    //se fizermos offset / 3 teremos o indice do triangulos?
+    
+    const auto material_id = mesh.materialIds[offset/3];
+    
+    Vertex vertex{};
+    vertex.position = {vx, vy, vz}; //a chave do vertex é sua posição e sua cor
+    vertex.color = {(float)material_id, (float)material_id, (float)material_id};
+    // fmt::print("position x: {} color r: {}\n", vertex.position.x, vertex.color.r);
+
+    //no arranjo de índices, podem haver posições duplicadas, pois os vértices podem ser compartilhados por triangulos diferentes
+    modelo.indices.push_back(welder.weld(vertex)); //índice do vértice, que é acrescentado ao arranjo se ainda não existir
+  }
+  modelo.vertices = welder.takeVertices();
+}
+
+//função para centralizar o modelo na origem e aplicar escala, 
+//normalizar as coordenadas de todos os vértices no intervalo [-1,1],
+//modificando vertices carregados do .obj para que a geometria caiba no volume de visão do pipeline gráfico,
+// que é o cubo de tamanho 2×2×2 centralizado em (0,0,0).
+void standardize(Modelo &modelo) {
+  // achar maiores e menores valores de x,y,z
+  glm::vec3 max(std::numeric_limits<float>::lowest());
+  glm::vec3 min(std::numeric_limits<float>::max());
+  for (const auto& vertex : modelo.vertices) {
+    max.x = std::max(max.x, vertex.position.x);
+    max.y = std::max(max.y, vertex.position.y);
+    max.z = std::max(max.z, vertex.position.z);
+    min.x = std::min(min.x, vertex.position.x);
+    min.y = std::min(min.y, vertex.position.y);
+    min.z = std::min(min.z, vertex.position.z);
+  }
+
+  
+  const auto center{(min + max) / 2.0f}; // calculo do centro da caixa
+  const auto scaling{2.0f / glm::length(max - min)}; //calculo do fator de escala, de forma que a maior dimensão da caixa tenha comprimento 2
+  //fmt::print("scaling: {}\n", scaling);
+  for (auto& vertex : modelo.vertices) {
+    vertex.position = (vertex.position - center) * scaling; //centralizar modelo na origem e aplicar escala
+  }
+}
+
+//níveis de detalhe: cada um simplifica o anterior até uma fração dos triângulos, sem passar de um erro máximo
+//(distância da superfície original, nas unidades do modelo padronizado, em que o dado mede 2).
+//as bordas entre materiais ficam travadas, então o contorno das pintas se mantém em todos os níveis
+struct AlvoDeNivel {
+  std::size_t divisor; //fração dos triângulos do nível completo
+  float erroMaximo;
+};
+constexpr std::array alvosDosNiveis{AlvoDeNivel{4, 0.01f}, AlvoDeNivel{16, 0.02f}, AlvoDeNivel{64, 0.05f}};
+
+//acrescenta os níveis simplificados depois dos índices do nível completo; todos usam o mesmo arranjo de vértices
+void gerarNiveis(Modelo &modelo) {
+  const auto completo{modelo.indices.size()};
+  modelo.niveis = {abcg::MeshLod{0, static_cast<std::uint32_t>(completo), 0.0}};
+  if (modelo.indices.empty()) return;
+
+  std::vector<std::uint32_t> anterior{modelo.indices};
+  double erroAcumulado{0.0};
+  for (const auto &alvo : alvosDosNiveis) {
+    float erro{};
+    auto indices{abcg::simplifyMesh(anterior, &modelo.vertices.front().position.x, modelo.vertices.size(),
+                                    sizeof(Vertex), completo / alvo.divisor, alvo.erroMaximo, &erro)};
+    //um nível que quase não reduz os triângulos só ocupa memória
+    if (indices.size() * 10 > anterior.size() * 9) break;
+
+    //os erros de simplificações sucessivas se somam, no máximo
+    erroAcumulado += erro;
+    modelo.niveis.push_back({static_cast<std::uint32_t>(modelo.indices.size()),
+                             static_cast<std::uint32_t>(indices.size()), erroAcumulado});
+    modelo.indices.insert(modelo.indices.end(), indices.begin(), indices.end());
+    anterior = std::move(indices);
+  }
+}
+
+//reordena triângulos e vértices para a GPU, sem mudar a geometria:
+//1. Tipsify: triângulos em leques que reaproveitam os vértices do cache pós-transformação do vertex shader;
+//2. overdraw: grupos de triângulos voltados para fora do dado vêm primeiro, e o teste de profundidade descarta
+//   mais fragmentos escondidos atrás deles (custa algumas falhas de cache a mais: no dado, ACMR 0.670 -> 0.719);
+//3. vertex fetch: vértices renumerados na ordem em que os índices os usam, lidos do VBO em sequência.
+//os passos 1 e 2 valem para cada nível de detalhe separadamente; o 3 segue a ordem do nível completo
+void otimizar(Modelo &modelo) {
+  if (modelo.indices.empty()) return;
+  const auto quantidade{modelo.vertices.size()};
+  for (const auto &nivel : modelo.niveis) {
+    const std::span indices{modelo.indices.data() + nivel.firstIndex, nivel.indexCount};
+    abcg::optimizeVertexCache(indices, quantidade);
+    abcg::optimizeOverdraw(indices, &modelo.vertices.front().position.x, quantidade, sizeof(Vertex));
+  }
+
+  const auto remapeamento{abcg::optimizeVertexFetch(modelo.indices, quantidade)};
+  std::vector<Vertex> vertices(quantidade - static_cast<std::size_t>(std::count(
+      remapeamento.begin(), remapeamento.end(), std::numeric_limits<std::uint32_t>::max())));
+  for (const auto i : iter::range(quantidade)) {
+    if (remapeamento[i] != std::numeric_limits<std::uint32_t>::max()) {
+      vertices[remapeamento[i]] = modelo.vertices[i];
+    }
+  }
+  modelo.vertices = std::move(vertices);
+}
+}  // namespace
+
+Modelo carregarModelo(std::string_view path) {
+  Modelo modelo;
+  loadModelFromFile(path, modelo); //carregamento do .obj
+  standardize(modelo);
+
+  //com a frente de todos os triângulos para fora, as faces de trás podem ser descartadas (GL_CULL_FACE).
+  //feito antes dos níveis de detalhe, que mantêm a orientação dos triângulos
+  if (!modelo.vertices.empty()) {
+    const auto orientacao{abcg::repairWinding(modelo.indices, &modelo.vertices.front().position.x,
+                                              modelo.vertices.size(), sizeof(Vertex))};
+    fmt::print("{}: {} superficies ({} fechadas), {} triangulos invertidos, {} arestas abertas, "
+               "{} arestas com mais de dois triangulos, {} arestas inconsistentes\n",
+               path, orientacao.surfaces, orientacao.closedSurfaces, orientacao.flippedTriangles,
+               orientacao.openEdges, orientacao.nonManifoldEdges, orientacao.inconsistentEdges);
+  }
+
+  //ACMR: vértices processados pelo vertex shader por triângulo; ATVR: por vértice distinto (1 é o ideal)
+  const auto antes{abcg::analyzeVertexCache(modelo.indices, modelo.vertices.size())};
+  gerarNiveis(modelo);
+  otimizar(modelo);
+  const auto depois{abcg::analyzeVertexCache(
+      std::span{modelo.indices}.first(modelo.niveis.front().indexCount), modelo.vertices.size())};
+  fmt::print("{}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}\n", path, antes.acmr, depois.acmr,
+             antes.atvr, depois.atvr);
+  for (const auto &nivel : modelo.niveis) {
+    fmt::print("  nivel de detalhe: {:6} triangulos, erro {:.4f}\n", nivel.indexCount / 3, nivel.error);
+  }
+  return modelo;
+}
+
+Modelo gerarCuboArredondado() {
+  using namespace dadoProcedural;
+  //cada face é uma grade de 4x4 vértices sobre o cubo [-1,1]^3: as duas linhas internas delimitam a parte plana
+  //e as externas são empurradas para a borda arredondada, meia borda para cada uma das faces vizinhas
+  const float interno{(meioLado - raioDaBorda) / meioLado};
+  const std::array grade{-1.0f, -interno, interno, 1.0f};
+
+  Modelo modelo;
+  for (const auto eixo : iter::range(3)) {
+    for (const float sinal : {1.0f, -1.0f}) {
+      //u, v e a normal formam uma base positiva, para os triângulos ficarem com a frente para fora
+      const auto u{(eixo + (sinal > 0.0f ? 1 : 2)) % 3};
+      const auto v{(eixo + (sinal > 0.0f ? 2 : 1)) % 3};
+      const auto primeiro{static_cast<std::uint32_t>(modelo.vertices.size())};
+      for (const auto j : iter::range(grade.size())) {
+        for (const auto i : iter::range(grade.size())) {
+          glm::vec3 ponto{};
+          ponto[eixo] = sinal * meioLado;
+          ponto[u] = grade[i] * meioLado;
+          ponto[v] = grade[j] * meioLado;
+          //ponto mais próximo no cubo interno, afastado de raioDaBorda na direção do ponto da grade
+          const auto centro{glm::clamp(ponto, glm::vec3{raioDaBorda - meioLado}, glm::vec3{meioLado - raioDaBorda})};
+          modelo.vertices.push_back({centro + raioDaBorda * glm::normalize(ponto - centro), glm::vec3{1.0f}});
+        }
+      }
+      for (const auto j : iter::range(grade.size() - 1)) {
+        for (const auto i : iter::range(grade.size() - 1)) {
+          const auto a{primeiro + static_cast<std::uint32_t>(j * grade.size() + i)};
+          const auto b{a + 1};
+          const auto c{a + static_cast<std::uint32_t>(grade.size())};
+          const auto d{c + 1};
+          modelo.indices.insert(modelo.indices.end(), {a, b, d, a, d, c});
+        }
+      }
+    }
+  }
+  modelo.niveis = {abcg::MeshLod{0, static_cast<std::uint32_t>(modelo.indices.size()), 0.0}};
+  return modelo;
+}
+
+MalhaCompacta compactar(const Modelo &modelo) {
+  MalhaCompacta malha;
+  malha.vertices.reserve(modelo.vertices.size());
+  for (const auto &vertex : modelo.vertices) {
+    VerticeCompacto compacto{};
+    for (const auto i : iter::range(3)) {
+      //arredondar em vez de truncar: erro máximo de meio passo, 1/65534 do tamanho do modelo
+      const auto coordenada{std::clamp(vertex.position[i], -1.0f, 1.0f)};
+      compacto.posicao[i] = static_cast<std::int16_t>(std::lround(coordenada * 32767.0f));
+    }
+    //a cor guarda o id do material nos três canais; sem material (-1) o shader já desenhava preto, como o 0
+    compacto.material = static_cast<std::uint8_t>(std::clamp(vertex.color.r, 0.0f, 255.0f));
+    malha.vertices.push_back(compacto);
+  }
+
+  //com até 65535 vértices, todo índice cabe em 16 bits: metade da memória e da banda do EBO.
+  //o índice 0xFFFF fica de fora porque o WebGL 2.0 sempre o trata como reinício de primitiva
+  if (modelo.vertices.size() <= std::numeric_limits<std::uint16_t>::max()) {
+    std::vector<std::uint16_t> indices(modelo.indices.begin(), modelo.indices.end());
+    const auto bytes{std::as_bytes(std::span{indices})};
+    malha.indices.assign(bytes.begin(), bytes.end());
+    malha.tamanhoDoIndice = sizeof(std::uint16_t);
+  } else {
+    const auto bytes{std::as_bytes(std::span{modelo.indices})};
+    malha.indices.assign(bytes.begin(), bytes.end());
+    malha.tamanhoDoIndice = sizeof(std::uint32_t);
+  }
+  malha.niveis = modelo.niveis;
+  return malha;
+}
+
+std::uint64_t hashDoModelo(std::string_view path) {
+  auto hash{abcg::hashFile(path)};
+  //os materiais definem a cor de cada triângulo, então o .mtl também faz parte da malha processada
+  auto materiais{std::filesystem::path{path}.replace_extension(".mtl")};
+  if (std::filesystem::exists(materiais)) hash = abcg::hashFile(materiais.string(), hash);
+  return hash;
+}
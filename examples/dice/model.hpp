@@ -0,0 +1,105 @@
+#ifndef MODEL_HPP_
+#define MODEL_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "abcg_meshcache.hpp"
+
+//atributos que definem um vértice: posição 3D, cor e operador == pra verificar se um vértice é igual a outro.
+//dois vértices só são iguais se todos os atributos forem iguais: na borda entre faces brancas e pretas
+//há um vértice de cada cor na mesma posição
+struct Vertex {
+  glm::vec3 position;
+  glm::vec3 color;
+
+  bool operator==(const Vertex& other) const {
+    return position == other.position && color == other.color;
+  }
+};
+//sem bytes de preenchimento: o abcg::VertexWelder compara e espalha os vértices byte a byte
+static_assert(sizeof(Vertex) == 6 * sizeof(float));
+
+//malha indexada pronta para ser enviada à GPU. Não depende de OpenGL, para poder ser gerada
+//também pela ferramenta dice_bake durante a compilação
+struct Modelo {
+  std::vector<Vertex> vertices; //vértices sem repetição, já padronizados
+  std::vector<std::uint32_t> indices; //três índices por triângulo, um nível de detalhe depois do outro
+  std::vector<abcg::MeshLod> niveis; //trecho de indices de cada nível, do completo ao mais simples
+};
+
+//vértice como vai para a GPU, 8 bytes no lugar dos 24 do Vertex:
+//posição em snorm16 (o modelo padronizado cabe em [-1,1], e o OpenGL converte -32767..32767 de volta para -1..1
+//com glVertexAttribPointer normalizado) e o id do material em um byte, que o shader usa como cor
+struct VerticeCompacto {
+  std::array<std::int16_t, 3> posicao;
+  std::uint8_t material;
+  std::uint8_t preenchimento; //completa 8 bytes, alinhando o vértice seguinte
+};
+static_assert(sizeof(VerticeCompacto) == 8);
+
+//malha no formato compacto. Os índices têm 16 bits se todos os vértices couberem neles, senão 32
+struct MalhaCompacta {
+  std::vector<VerticeCompacto> vertices;
+  std::vector<std::byte> indices; //bytes do arranjo de índices de tamanhoDoIndice bytes cada
+  std::size_t tamanhoDoIndice{};
+  std::vector<abcg::MeshLod> niveis; //trecho de indices de cada nível de detalhe
+
+  [[nodiscard]] std::size_t quantidadeDeIndices() const noexcept {
+    return tamanhoDoIndice == 0 ? 0 : indices.size() / tamanhoDoIndice;
+  }
+};
+
+//malha lida, pronta para ser enviada à GPU: mapeada do .mesh pré-processado ou, na falta dele,
+//compactada aqui mesmo a partir do .obj (ou gerada, no caso do dado procedural)
+struct MalhaCarregada {
+  abcg::MeshCache cache{}; //válido se a malha veio do arquivo pré-processado
+  MalhaCompacta malha{}; //usada quando cache não é válido
+
+  [[nodiscard]] std::span<const VerticeCompacto> vertices() const noexcept {
+    return cache.isValid() ? cache.vertices<VerticeCompacto>() : std::span<const VerticeCompacto>{malha.vertices};
+  }
+  [[nodiscard]] std::span<const std::byte> indices() const noexcept {
+    return cache.isValid() ? cache.indexBytes() : std::span<const std::byte>{malha.indices};
+  }
+  [[nodiscard]] std::size_t tamanhoDoIndice() const noexcept {
+    return cache.isValid() ? cache.indexSize() : malha.tamanhoDoIndice;
+  }
+  [[nodiscard]] std::span<const abcg::MeshLod> niveis() const noexcept {
+    return cache.isValid() ? cache.lods() : std::span<const abcg::MeshLod>{malha.niveis};
+  }
+};
+
+//incrementar sempre que o processamento abaixo mudar, para invalidar malhas pré-processadas antigas.
+//vai no cabeçalho do .mesh, então vale também para a malha empacotada sem o .obj
+inline constexpr std::uint64_t versaoDoProcessamento{6};
+
+//lê o .obj (e o .mtl que ele referencia), remove vértices repetidos, padroniza a escala,
+//gera os níveis de detalhe e reordena triângulos e vértices para o cache de vértices da GPU
+[[nodiscard]] Modelo carregarModelo(std::string_view path);
+//dado desenhado sem o .obj: cubo de 108 triângulos com as arestas arredondadas, e as pintas calculadas
+//no fragment shader (dice_pintas.frag). As medidas vêm do dice.obj, já na escala de standardize()
+namespace dadoProcedural {
+inline constexpr float meioLado{0.445f}; //metade da aresta do cubo
+inline constexpr float raioDaBorda{0.1f}; //raio do arredondamento das arestas
+//colunas: normais das faces 1, 2 e 4 no referencial do dice.obj, que tem o dado girado.
+//com elas o cubo é gerado alinhado aos eixos e girado no vertex shader para a mesma posição do modelo,
+//e os angulosRetos da simulação continuam mostrando as mesmas faces
+inline constexpr std::array<float, 9> orientacaoDasFaces{0.94436f, 0.30491f, -0.12332f,
+                                                         0.22018f, -0.30753f, 0.92571f,
+                                                         0.24434f, -0.90136f, -0.35756f};
+}  // namespace dadoProcedural
+
+//cubo arredondado do dadoProcedural, no referencial das faces (+x = 1, +y = 2, +z = 4), todo branco
+[[nodiscard]] Modelo gerarCuboArredondado();
+//converte a malha padronizada para o formato da GPU, escolhendo índices de 16 bits quando possível
+[[nodiscard]] MalhaCompacta compactar(const Modelo &modelo);
+//hash do .obj e do .mtl ao lado dele: identifica a fonte da malha processada
+[[nodiscard]] std::uint64_t hashDoModelo(std::string_view path);
+
+#endif
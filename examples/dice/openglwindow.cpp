@@ -2,25 +2,22 @@
 
 #include <fmt/core.h>
 #include <imgui.h>
-#include <tiny_obj_loader.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cppitertools/itertools.hpp>
+#include <filesystem>
+#include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/fast_trigonometry.hpp>
-#include <glm/gtx/hash.hpp>
-#include <unordered_map>
-
-// Explicit specialization of std::hash for Vertex
-namespace std {
-template <>
-//necessário para podermos usar Vertex como chave para pegar um valor de índice de uma tabela hash 
-//isso ajuda a compactar bem nossa geometria indexada
-struct hash<Vertex> {
-  size_t operator()(Vertex const& vertex) const noexcept {
-    const std::size_t h1{std::hash<glm::vec3>()(vertex.position)}; //como é 3D e hash já possui uma especialização para vec3, vamos usar isso por enquanto
-    return h1;
-  }
-};
-}  // namespace std
+
+//uniformes constantes do dado procedural; ficam guardados no programa
+static void configurarPintas(GLuint program) {
+  const abcg::ProgramReflection reflection{program};
+  abcg::glUseProgram(program);
+  reflection.uniform<glm::mat3>("orientacaoDasFaces").set(glm::make_mat3(dadoProcedural::orientacaoDasFaces.data()));
+  reflection.uniform<GLfloat>("meioLado").set(dadoProcedural::meioLado);
+  abcg::glUseProgram(0);
+}
 
 void OpenGLWindow::initializeGL() {
   abcg::glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -28,119 +25,169 @@ void OpenGLWindow::initializeGL() {
   // Enable depth buffering
   abcg::glEnable(GL_DEPTH_TEST); //descartar fragmentos dependendo da profundidade
 
-  // Create program
-  m_program = createProgramFromFile(getAssetsPath() + "dice.vert",
-                                    getAssetsPath() + "dice.frag");
-
-  // Load model
-  loadModelFromFile(getAssetsPath() + "dice.obj"); //carregamento do .obj
-  standardize();
+  //virar a face pra fora: sem matriz de projeção, o z da tela aponta para dentro e os triângulos
+  //anti-horários vistos de fora do modelo aparecem horários
+  abcg::glFrontFace(GL_CW);
+  aplicarDescarteDeFaces();
 
   #if !defined(__EMSCRIPTEN__)
     abcg::glEnable(GL_PROGRAM_POINT_SIZE);
   #endif
 
-  m_verticesToDraw = m_indices.size();
-  //fmt::print("quantity: {}\n", quantity);
-  m_dices.initializeGL(m_program, quantity, m_vertices, m_indices, m_verticesToDraw);
+  const auto malha{carregarMalha()};
+  m_dices.initializeGL(m_program, m_instancedProgram, quantity, malha->gpu());
+
+  if(m_quadrosPorMedida > 0){
+    for(const int quantidade : {1, 100, 10000, 100000}){
+      for(const bool instanciado : {true, false}){
+        auto &medida{m_medidas.emplace_back()};
+        medida.quantidade = quantidade;
+        medida.instanciado = instanciado;
+      }
+    }
+    m_medidaAtual = 0;
+    iniciarMedida();
+  }
 }
 
-//carregar e ler o arquivo .obj, armazenar vertices e indices em m_vertices e m_indices.
-void OpenGLWindow::loadModelFromFile(std::string_view path) {
-  tinyobj::ObjReader reader;
+//os dados são jogados no começo de cada medida, então ela inclui a simulação e o reenvio das matrizes de quem gira.
+//mesas grandes usam dados menores, como em benchmarks/collisions.cpp, para que caibam sem se sobrepor
+void OpenGLWindow::iniciarMedida() {
+  const auto &medida{m_medidas.at(m_medidaAtual)};
+  m_dices.resize(medida.quantidade);
+  m_dices.definirEscala(std::min(1.0f, std::sqrt(3.0f / static_cast<float>(medida.quantidade))));
+  m_dices.m_instanced = medida.instanciado;
+  m_dices.jogarDados();
+  m_quadroDaMedida = 0;
+  m_tempoDoQuadro.restart();
+}
 
-  if (!reader.ParseFromFile(path.data())) {
-    if (!reader.Error().empty()) {
-      throw abcg::Exception{abcg::Exception::Runtime(
-          fmt::format("Failed to load model {} ({})", path, reader.Error()))};
+//chamado no começo de cada quadro: o tempo desde o começo do anterior é a duração dele, com a troca de buffers.
+//os primeiros quadros de cada configuração, que recriam buffers, não entram na medida
+void OpenGLWindow::registrarQuadro() {
+  constexpr int quadrosDeAquecimento{10};
+  const auto duracao{m_tempoDoQuadro.restart()};
+  auto &medida{m_medidas.at(m_medidaAtual)};
+  if(m_quadroDaMedida > quadrosDeAquecimento){
+    medida.quadros.push_back(duracao);
+    medida.drawCalls = m_dices.m_drawCalls;
+    medida.triangulos = m_dices.m_triangulos;
+    medida.submissao += m_dices.m_tempoSubmissao;
+  }
+  if(m_quadroDaMedida == quadrosDeAquecimento + m_quadrosPorMedida){
+    if(++m_medidaAtual == m_medidas.size()){
+      imprimirMedidas();
+      m_quadrosPorMedida = 0;
+      //no WebAssembly o laço principal ignora o pedido e o exemplo continua aberto
+      SDL_Event sair{};
+      sair.type = SDL_QUIT;
+      SDL_PushEvent(&sair);
+      return;
     }
-    throw abcg::Exception{
-        abcg::Exception::Runtime(fmt::format("Failed to load model {}", path))};
+    iniciarMedida();
   }
+  ++m_quadroDaMedida;
+}
+
+void OpenGLWindow::imprimirMedidas() const {
+  //percentil pelo posto mais próximo, em milissegundos
+  const auto percentil{[](const std::vector<double> &ordenados, double p) {
+    const auto posto{static_cast<std::size_t>(std::ceil(p * static_cast<double>(ordenados.size())))};
+    return 1000.0 * ordenados.at(std::max<std::size_t>(posto, 1) - 1);
+  }};
 
-  if (!reader.Warning().empty()) {
-    fmt::print("Warning: {}\n", reader.Warning());
+  fmt::print("{} quadros por medida, viewport {}x{}, tempos em ms\n", m_quadrosPorMedida, m_viewportWidth,
+             m_viewportHeight);
+  fmt::print("{:>7} {:>12} {:>10} {:>11} {:>8} {:>8} {:>8} {:>8} {:>10}\n", "dados", "modo", "draw calls",
+             "triangulos", "media", "p50", "p95", "p99", "submissao");
+  for(const auto &medida : m_medidas){
+    auto ordenados{medida.quadros};
+    std::sort(ordenados.begin(), ordenados.end());
+    const auto quantidade{static_cast<double>(ordenados.size())};
+    double total{};
+    for(const auto duracao : ordenados) total += duracao;
+    fmt::print("{:>7} {:>12} {:>10} {:>11} {:>8.3f} {:>8.3f} {:>8.3f} {:>8.3f} {:>10.3f}\n", medida.quantidade,
+               medida.instanciado ? "instanciado" : "por dado", medida.drawCalls, medida.triangulos,
+               1000.0 * total / quantidade, percentil(ordenados, 0.50), percentil(ordenados, 0.95),
+               percentil(ordenados, 0.99), 1000.0 * medida.submissao / quantidade);
   }
+}
 
-  const auto& attrib{reader.GetAttrib()}; //conjunto de vertices
-  const auto& shapes{reader.GetShapes()}; //conjunto de objetos (só tem 1)
-
-  m_vertices.clear();
-  m_indices.clear();
-
-  // A key:value map with key=Vertex and value=index
-  std::unordered_map<Vertex, GLuint> hash{};
-
-  // ler todos os triangulos e vertices
-  for (const auto& shape : shapes) { 
-    // pra cada um dos indices
-    for (const auto offset : iter::range(shape.mesh.indices.size())) { //122112 indices = numero de triangulos * 3
-      // Access to vertex
-      const tinyobj::index_t index{shape.mesh.indices.at(offset)}; //offset vai ser de 0 a 122112, index vai acessar cada vertice nessas posições offset
-
-      // Vertex position
-      const int startIndex{3 * index.vertex_index}; //startIndex vai encontrar o indice exato de cada vertice
-      const float vx{attrib.vertices.at(startIndex + 0)};
-      const float vy{attrib.vertices.at(startIndex + 1)};
-      const float vz{attrib.vertices.at(startIndex + 2)};
-
-      //são 40704 triangulos, dos quais 27264 brancos.
-      //se fizermos offset / 3 teremos o indice do triangulos?
-      
-      const auto material_id = shape.mesh.material_ids.at(offset/3);
-      
-      Vertex vertex{};
-      vertex.position = {vx, vy, vz}; //a chave do vertex é sua posição
-      vertex.color = {(float)material_id, (float)material_id, (float)material_id};
-      // fmt::print("position x: {} color r: {}\n", vertex.position.x, vertex.color.r);
-
-      // If hash doesn't contain this vertex
-      if (hash.count(vertex) == 0) {
-        // Add this index (size of m_vertices)
-        hash[vertex] = m_vertices.size(); //o valor do hash é a ordem que esse vertex foi lido
-        // Add this vertex
-        m_vertices.push_back(vertex); //o vértice é adicionado ao arranjo de vértices, se ainda não existir
-      }
-      //no arranjo de índices, podem haver posições duplicadas, pois os vértices podem ser compartilhados por triangulos diferentes
-      m_indices.push_back(hash[vertex]); //o valor do hash deste vértice (suua ordem) é adicionado ao arranjo de indices
-    }
+//escolhe m_program, m_instancedProgram e a malha conforme m_pintasNoShader.
+//programas e malhas ficam em m_assets: trocar de modo não recompila os shaders nem relê o .obj
+std::shared_ptr<const MeshAsset> OpenGLWindow::carregarMalha() {
+  const auto criarPrograma{[this](std::string_view vertexPath, std::string_view fragmentPath) {
+    return createProgramFromFile(vertexPath, fragmentPath);
+  }};
+  const auto assets{getAssetsPath()};
+
+  //cada malha vai para a GPU uma vez; o cache guarda os buffers, e os vértices e índices lidos são descartados
+  std::shared_ptr<const MeshAsset> malha;
+  if (m_pintasNoShader) {
+    //cubo arredondado de 108 triângulos, com as pintas calculadas por fragmento: não precisa do .obj
+    m_program = m_assets.program(assets + "dice_pintas.vert", assets + "dice_pintas.frag", criarPrograma);
+    m_instancedProgram = m_assets.program(assets + "dice_pintas_instanced.vert", assets + "dice_pintas.frag",
+                                          criarPrograma);
+    configurarPintas(m_program);
+    configurarPintas(m_instancedProgram);
+    malha = m_assets.get<MeshAsset>("dadoProcedural", [this] {
+      return MeshAsset::enviar(abcg::ProgramReflection{m_program},
+                               MalhaCarregada{.malha = compactar(gerarCuboArredondado())});
+    });
+  } else {
+    m_program = m_assets.program(assets + "dice.vert", assets + "dice.frag", criarPrograma);
+    m_instancedProgram = m_assets.program(assets + "dice_instanced.vert", assets + "dice.frag", criarPrograma);
+    malha = m_assets.get<MeshAsset>(assets + "dice.obj", [&] {
+      return MeshAsset::enviar(abcg::ProgramReflection{m_program},
+                               loadModel(assets + "dice.obj", assets + "dice.mesh"));
+    });
   }
+  m_memoriaDaMalha = malha->memoria();
+  return malha;
 }
 
-//função para centralizar o modelo na origem e aplicar escala, 
-//normalizar as coordenadas de todos os vértices no intervalo [-1,1],
-//modificando vertices carregados do .obj para que a geometria caiba no volume de visão do pipeline gráfico,
-// que é o cubo de tamanho 2×2×2 centralizado em (0,0,0).
-void OpenGLWindow::standardize() {
-  // achar maiores e menores valores de x,y,z
-  glm::vec3 max(std::numeric_limits<float>::lowest());
-  glm::vec3 min(std::numeric_limits<float>::max());
-  for (const auto& vertex : m_vertices) {
-    max.x = std::max(max.x, vertex.position.x);
-    max.y = std::max(max.y, vertex.position.y);
-    max.z = std::max(max.z, vertex.position.z);
-    min.x = std::min(min.x, vertex.position.x);
-    min.y = std::min(min.y, vertex.position.y);
-    min.z = std::min(min.z, vertex.position.z);
+//a malha já processada (sem vértices repetidos e padronizada) fica num arquivo binário ao lado do .obj,
+//gerado pelo dice_bake e versionado com os assets; se estiver desatualizado, é refeito na primeira execução.
+//se o arquivo foi gerado a partir deste mesmo .obj, ele é só mapeado em memória e enviado à GPU, sem interpretação;
+//senão o .obj é lido e compactado, e o resultado é gravado para a próxima execução
+MalhaCarregada OpenGLWindow::loadModel(const std::string &objPath, const std::string &cachePath) {
+  //o build WebAssembly empacota só a malha pré-processada, sem o .obj para conferir
+  if (!std::filesystem::exists(objPath)) {
+    auto cache{abcg::MeshCache::loadPrebuilt(cachePath, versaoDoProcessamento, sizeof(VerticeCompacto))};
+    if (!cache.isValid()) {
+      throw abcg::Exception{abcg::Exception::Runtime(
+          fmt::format("Failed to load model {}", cachePath))};
+    }
+    return {.cache = std::move(cache)};
   }
 
-  
-  const auto center{(min + max) / 2.0f}; // calculo do centro da caixa
-  const auto scaling{2.0f / glm::length(max - min)}; //calculo do fator de escala, de forma que a maior dimensão da caixa tenha comprimento 2
-  //fmt::print("scaling: {}\n", scaling);
-  for (auto& vertex : m_vertices) {
-    vertex.position = (vertex.position - center) * scaling; //centralizar modelo na origem e aplicar escala
+  const auto sourceHash{hashDoModelo(objPath)};
+  auto cache{abcg::MeshCache::load(cachePath, sourceHash, versaoDoProcessamento, sizeof(VerticeCompacto))};
+  if (cache.isValid()) return {.cache = std::move(cache)};
+
+  MalhaCarregada carregada{.malha = compactar(carregarModelo(objPath))};
+  const auto &malha{carregada.malha};
+  try {
+    abcg::MeshCache::save(cachePath, sourceHash, versaoDoProcessamento, sizeof(VerticeCompacto),
+                          std::as_bytes(std::span{malha.vertices}), malha.indices,
+                          malha.tamanhoDoIndice, malha.niveis);
+  } catch (const abcg::Exception &exception) {
+    //sem permissão de escrita nos assets, por exemplo: seguimos sem cache
+    fmt::print("Warning: {}\n", exception.what());
   }
+  return carregada;
 }
 
 void OpenGLWindow::paintGL() {
-  
+    if(m_quadrosPorMedida > 0) registrarQuadro();
+
     // Clear color buffer and depth buffer
     abcg::glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     abcg::glViewport(0, 0, m_viewportWidth, m_viewportHeight);
     
-    m_dices.paintGL(m_viewportWidth, m_viewportHeight, getDeltaTime());
+    m_dices.update(getDeltaTime());
+    m_dices.paintGL();
 }
 
 void OpenGLWindow::paintUI() {
@@ -148,22 +195,34 @@ void OpenGLWindow::paintUI() {
   //Janela de opções
   {
     ImGui::SetNextWindowPos(ImVec2(5,5));
-    ImGui::SetNextWindowSize(ImVec2(128, 70));
+    ImGui::SetNextWindowSize(ImVec2(220, 300));
     ImGui::Begin("Button window", nullptr, ImGuiWindowFlags_NoDecoration);
 
     ImGui::PushItemWidth(200);
     //Botão jogar dado
     if(ImGui::Button("Jogar!")){
-      for(auto &dice : m_dices.m_dices){
-        m_dices.jogarDado(dice);
+      m_dices.jogarDados();
+    }
+    //entrada e saída de um dado por vez, sem recriar a mesa
+    ImGui::SameLine();
+    if(ImGui::Button("+1")){
+      m_dadosAvulsos.push_back(m_dices.adicionarDado());
+    }
+    ImGui::SameLine();
+    if(ImGui::Button("-1")){
+      //handles de dados que saíram com a troca de quantidade já não valem e são descartados
+      while(!m_dadosAvulsos.empty()){
+        const auto dado{m_dadosAvulsos.back()};
+        m_dadosAvulsos.pop_back();
+        if(m_dices.removerDado(dado)) break;
       }
-      
     }
     ImGui::PopItemWidth();
     // Number of dices combo box
     {
       static std::size_t currentIndex{};
-      const std::vector<std::string> comboItems{"1", "2", "3"};
+      //as quantidades maiores servem para comparar o custo de desenho dos dois modos
+      const std::vector<std::string> comboItems{"1", "2", "3", "100", "10000", "100000"};
 
       ImGui::PushItemWidth(70);
       if (ImGui::BeginCombo("Dados",
@@ -177,26 +236,62 @@ void OpenGLWindow::paintUI() {
         ImGui::EndCombo();
       }
       ImGui::PopItemWidth();
-      if(quantity != (int)currentIndex + 1){
-        quantity = currentIndex + 1;
-        initializeGL();
+      if(quantity != std::stoi(comboItems.at(currentIndex))){
+        quantity = std::stoi(comboItems.at(currentIndex));
+        //só a simulação e as matrizes mudam de tamanho; malha e programas continuam na GPU
+        m_dices.resize(quantity);
       }
     }
 
+    //modo de desenho e medidas do último quadro
+    ImGui::Checkbox("Instanciado", &m_dices.m_instanced);
+    if(ImGui::IsItemHovered()){
+      ImGui::SetTooltip("Desligado, cada dado custa uma chamada de desenho por quadro, mesmo parado");
+    }
+    ImGui::Checkbox("Níveis de detalhe", &m_dices.m_niveisDeDetalhe);
+    if(ImGui::Checkbox("Descartar faces de trás", &m_descartarFacesDeTras)){
+      aplicarDescarteDeFaces();
+    }
+    //troca a malha e os shaders; como na troca de quantidade, os dados continuam na mesa
+    if(ImGui::Checkbox("Pintas no shader", &m_pintasNoShader)){
+      const auto malha{carregarMalha()};
+      m_dices.usarMalha(m_program, m_instancedProgram, malha->gpu());
+    }
+    ImGui::Text("Draw calls: %d", m_dices.m_drawCalls);
+    ImGui::Text("Triângulos: %lld", m_dices.m_triangulos);
+    //só os dados girando, e os que acabaram de mudar, têm a matriz recalculada e reenviada. Fora do modo
+    //instanciado, todos os dados ainda são desenhados um a um a cada quadro
+    ImGui::Text("Atualizados: %zu de %zu", m_dices.m_dadosAtualizados, m_dices.quantidade());
+    //geometria que continua na memória depois do envio: só a da GPU, a menos que a malha seja mantida na CPU
+    ImGui::Text("Malha: %zu KiB GPU, %zu KiB CPU", m_memoriaDaMalha.gpu / 1024,
+                (m_memoriaDaMalha.cpu + m_memoriaDaMalha.mapeada) / 1024);
+    ImGui::Text("Submissão: %.3f ms", m_dices.m_tempoSubmissao * 1000.0);
+    ImGui::Text("Quadro: %.3f ms", 1000.0 / std::max(ImGui::GetIO().Framerate, 1.0f));
+
     
     ImGui::End();
   }
-  
-  //virar a face pra fora
-  abcg::glFrontFace(GL_CW);
+}
+
+//com a orientação dos triângulos corrigida na carga do modelo, as faces de trás de um dado fechado nunca
+//aparecem, e o GL_CULL_FACE as descarta antes da rasterização
+void OpenGLWindow::aplicarDescarteDeFaces() {
+  if (m_descartarFacesDeTras) {
+    abcg::glEnable(GL_CULL_FACE);
+    abcg::glCullFace(GL_BACK);
+  } else {
+    abcg::glDisable(GL_CULL_FACE);
+  }
 }
 
 void OpenGLWindow::resizeGL(int width, int height) {
   m_viewportWidth = width;
   m_viewportHeight = height;
+  m_dices.resizeGL(width, height);
 }
 
 void OpenGLWindow::terminateGL() {
-  abcg::glDeleteProgram(m_program);
   m_dices.terminateGL();
+  //os programas pertencem ao cache
+  m_assets.clear();
 }
\ No newline at end of file
@@ -1,12 +1,18 @@
 #ifndef OPENGLWINDOW_HPP_
 #define OPENGLWINDOW_HPP_
 
+#include <algorithm>
 #include <vector>
 #include <random>
 #include "abcg.hpp"
 #include "dices.hpp"
 
 class OpenGLWindow : public abcg::OpenGLWindow {
+ public:
+  //roteiro de medição (dice --benchmark): cada quantidade de dados é desenhada por quadros quadros em cada modo,
+  //depois o programa imprime chamadas de desenho e tempos de quadro e termina
+  void medirDesempenho(int quadros) { m_quadrosPorMedida = std::max(quadros, 1); }
+
  protected:
   void initializeGL() override;
   void paintGL() override;
@@ -16,18 +22,40 @@ class OpenGLWindow : public abcg::OpenGLWindow {
 
  private:
   GLuint m_program{};
-  std::vector<Vertex> m_vertices; //arranjo de vértices lido do arquivo OBJ que será enviado ao VBO
-  std::vector<GLuint> m_indices; //arranjo de indices lido do arquivo OBJ que será enviado ao EBO
-  int m_verticesToDraw{}; //quantidade de vértices do VBO que será processada pela função de renderização, glDrawElements
+  GLuint m_instancedProgram{};
+  abcg::AssetCache m_assets; //programas e malhas já carregados, por caminho
+  RelatorioDeMemoria m_memoriaDaMalha; //da malha em uso
+  bool m_pintasNoShader{false};
+  bool m_descartarFacesDeTras{true}; //GL_CULL_FACE: só as faces da frente são rasterizadas
 
   Dices m_dices;
   int quantity{1};
+  std::vector<DiceHandle> m_dadosAvulsos; //dados que entraram pelo botão "+1", do mais antigo ao mais novo
 
   int m_viewportWidth{};
   int m_viewportHeight{};
 
-  void loadModelFromFile(std::string_view path);
-  void standardize();
+  //uma configuração do roteiro de medição e o que foi medido nela
+  struct Medida {
+    int quantidade{};
+    bool instanciado{};
+    int drawCalls{}; //do último quadro medido
+    long long triangulos{};
+    double submissao{}; //soma dos tempos de submissão, em segundos
+    std::vector<double> quadros; //duração de cada quadro medido, em segundos
+  };
+  int m_quadrosPorMedida{}; //0 = sem roteiro de medição
+  std::vector<Medida> m_medidas;
+  std::size_t m_medidaAtual{};
+  int m_quadroDaMedida{}; //quadros já desenhados com a configuração atual
+  abcg::ElapsedTimer m_tempoDoQuadro;
+
+  std::shared_ptr<const MeshAsset> carregarMalha();
+  MalhaCarregada loadModel(const std::string &objPath, const std::string &cachePath);
+  void aplicarDescarteDeFaces();
+  void iniciarMedida();
+  void registrarQuadro();
+  void imprimirMedidas() const;
 };
 
 #endif
\ No newline at end of file
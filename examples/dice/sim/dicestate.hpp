@@ -0,0 +1,92 @@
+#ifndef DICESTATE_HPP_
+#define DICESTATE_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//estado de simulação dos dados como estrutura de arranjos (SoA): cada grandeza fica num arranjo contíguo,
+//indexado pelo número do dado, o que permite integrar vários dados por instrução SIMD
+struct DiceState {
+  //translação na mesa e velocidade com sinal, em unidades da mesa por segundo
+  std::vector<float> posX, posY;
+  std::vector<float> velX, velY;
+
+  //ângulos em [0, 2π) e velocidades angulares em rad/s (zero nos eixos que não estão girando)
+  std::vector<float> angX, angY, angZ;
+  std::vector<float> velAngX, velAngY, velAngZ;
+
+  //passos de simulação que faltam para o dado pousar; zero = dado parado
+  std::vector<std::int32_t> passosRestantes;
+  std::vector<std::uint8_t> colidindo;
+  std::vector<std::uint8_t> face; //número (1 a 6) sorteado no último pouso
+
+  //identificador permanente do dado no contador do gerador; não muda quando outros dados saem da mesa
+  std::vector<std::uint32_t> id;
+
+  //contadores do gerador: lançamentos já feitos por dado (0 = posição inicial) e
+  //blocos de velocidades já sorteados no lançamento atual (um no arremesso e um por quique)
+  std::vector<std::uint32_t> lancamento;
+  std::vector<std::uint32_t> sorteios;
+
+  //estado do passo anterior, usado para interpolar a renderização entre passos
+  std::vector<float> posXAnterior, posYAnterior;
+  std::vector<float> angXAnterior, angYAnterior, angZAnterior;
+
+  [[nodiscard]] std::size_t size() const { return posX.size(); }
+
+  void resize(std::size_t count) {
+    paraCadaArranjo([&](auto &arranjo, auto inicial) { arranjo.assign(count, inicial); });
+  }
+
+  //muda a quantidade mantendo o estado dos primeiros min(size(), count) dados; os novos começam como em resize
+  void redimensionar(std::size_t count) {
+    paraCadaArranjo([&](auto &arranjo, auto inicial) { arranjo.resize(count, inicial); });
+  }
+
+  void reserve(std::size_t capacidade) {
+    paraCadaArranjo([&](auto &arranjo, auto) { arranjo.reserve(capacidade); });
+  }
+
+  //remove o dado copiando o último para o seu lugar, em O(1); só o índice do último muda
+  void removerTrocandoComOUltimo(std::size_t index) {
+    paraCadaArranjo([&](auto &arranjo, auto) {
+      arranjo[index] = arranjo.back();
+      arranjo.pop_back();
+    });
+  }
+
+  //troca dois dados de lugar nos arranjos
+  void trocar(std::size_t a, std::size_t b) {
+    paraCadaArranjo([&](auto &arranjo, auto) { std::swap(arranjo[a], arranjo[b]); });
+  }
+
+  //guarda o estado atual dos dados [0, quantidade) como o do passo anterior
+  void salvarAnterior(std::size_t quantidade) {
+    std::copy_n(posX.begin(), quantidade, posXAnterior.begin());
+    std::copy_n(posY.begin(), quantidade, posYAnterior.begin());
+    std::copy_n(angX.begin(), quantidade, angXAnterior.begin());
+    std::copy_n(angY.begin(), quantidade, angYAnterior.begin());
+    std::copy_n(angZ.begin(), quantidade, angZAnterior.begin());
+  }
+
+  //chama f(arranjo, valor de um dado novo) para cada arranjo; é a única lista deles, então um campo novo
+  //só precisa entrar aqui para ser redimensionado, reservado, trocado e removido junto com os demais
+  template <typename F>
+  void paraCadaArranjo(F &&f) {
+    for(auto *arranjo : {&posX, &posY, &velX, &velY, &angX, &angY, &angZ,
+                         &velAngX, &velAngY, &velAngZ, &posXAnterior, &posYAnterior,
+                         &angXAnterior, &angYAnterior, &angZAnterior}) {
+      f(*arranjo, 0.0f);
+    }
+    f(passosRestantes, std::int32_t{0});
+    f(colidindo, std::uint8_t{0});
+    f(face, std::uint8_t{1});
+    f(id, std::uint32_t{0});
+    f(lancamento, std::uint32_t{0});
+    f(sorteios, std::uint32_t{0});
+  }
+};
+
+#endif
@@ -0,0 +1,222 @@
+#include "integration.hpp"
+
+#include <cmath>
+#include <numbers>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__)) && \
+    !defined(__EMSCRIPTEN__)
+#define DICE_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+constexpr float doisPi{2.0f * std::numbers::pi_v<float>};
+constexpr float inversoDoisPi{1.0f / doisPi};
+
+//mantém o ângulo em [0, 2π)
+inline float normalizarAngulo(float angulo) {
+  return angulo - doisPi * std::floor(angulo * inversoDoisPi);
+}
+
+//processa os dados [inicio, fim) um a um; também cuida das sobras dos kernels vetorizados.
+//os kernels vetorizados fazem exatamente as mesmas operações (sem FMA), então o resultado é idêntico ao escalar
+void integrarEscalar(DiceState &e, std::size_t inicio, std::size_t fim, float dt, float limite,
+                     EventosPasso &eventos) {
+  for(auto i{inicio}; i < fim; ++i) {
+    const auto index{static_cast<std::uint32_t>(i)};
+
+    //rebate só se estiver fora da mesa e indo para fora; dado parado tem velocidade zero e nunca quica
+    bool quicou{false};
+    if((e.posX[i] >= limite && e.velX[i] > 0.0f) || (e.posX[i] <= -limite && e.velX[i] < 0.0f)) {
+      e.velX[i] = -e.velX[i];
+      quicou = true;
+    }
+    if((e.posY[i] >= limite && e.velY[i] > 0.0f) || (e.posY[i] <= -limite && e.velY[i] < 0.0f)) {
+      e.velY[i] = -e.velY[i];
+      quicou = true;
+    }
+    if(quicou) eventos.quiques.push_back(index);
+
+    e.posX[i] += e.velX[i] * dt;
+    e.posY[i] += e.velY[i] * dt;
+
+    e.angX[i] = normalizarAngulo(e.angX[i] + e.velAngX[i] * dt);
+    e.angY[i] = normalizarAngulo(e.angY[i] + e.velAngY[i] * dt);
+    e.angZ[i] = normalizarAngulo(e.angZ[i] + e.velAngZ[i] * dt);
+
+    if(e.passosRestantes[i] > 0) {
+      if(--e.passosRestantes[i] == 0) eventos.pousos.push_back(index);
+    }
+  }
+}
+
+#if defined(DICE_SIMD_X86)
+//acrescenta aos eventos os dados [base, base + largura) cujo bit está ligado na máscara
+inline void registrar(std::vector<std::uint32_t> &lista, int mascara, std::size_t base) {
+  while(mascara != 0) {
+    const int lane{__builtin_ctz(static_cast<unsigned>(mascara))};
+    lista.push_back(static_cast<std::uint32_t>(base) + static_cast<std::uint32_t>(lane));
+    mascara &= mascara - 1;
+  }
+}
+
+//inverte o sinal da velocidade nas lanes que estão fora da mesa indo para fora; retorna a máscara do quique
+__attribute__((target("sse4.1"))) inline __m128 rebater(__m128 pos, __m128 &vel, __m128 limite) {
+  const __m128 zero{_mm_setzero_ps()};
+  const __m128 menosLimite{_mm_sub_ps(zero, limite)};
+  const __m128 saindoPositivo{_mm_and_ps(_mm_cmpge_ps(pos, limite), _mm_cmpgt_ps(vel, zero))};
+  const __m128 saindoNegativo{_mm_and_ps(_mm_cmple_ps(pos, menosLimite), _mm_cmplt_ps(vel, zero))};
+  const __m128 quique{_mm_or_ps(saindoPositivo, saindoNegativo)};
+  vel = _mm_xor_ps(vel, _mm_and_ps(quique, _mm_set1_ps(-0.0f)));
+  return quique;
+}
+
+__attribute__((target("sse4.1"))) inline void girar(float *angulo, const float *velocidade, __m128 dt) {
+  const __m128 a{_mm_add_ps(_mm_loadu_ps(angulo), _mm_mul_ps(_mm_loadu_ps(velocidade), dt))};
+  const __m128 voltas{_mm_floor_ps(_mm_mul_ps(a, _mm_set1_ps(inversoDoisPi)))};
+  _mm_storeu_ps(angulo, _mm_sub_ps(a, _mm_mul_ps(voltas, _mm_set1_ps(doisPi))));
+}
+
+__attribute__((target("sse4.1"))) void integrarSSE41(DiceState &e, std::size_t n, float dt, float limite,
+                                                      EventosPasso &eventos) {
+  const std::size_t fimVetorial{n - n % 4};
+
+  const __m128 vdt{_mm_set1_ps(dt)};
+  const __m128 vLimite{_mm_set1_ps(limite)};
+  const __m128i umInteiro{_mm_set1_epi32(1)};
+  const __m128i zeroInteiro{_mm_setzero_si128()};
+
+  for(std::size_t i{0}; i < fimVetorial; i += 4) {
+    const __m128 px{_mm_loadu_ps(&e.posX[i])};
+    const __m128 py{_mm_loadu_ps(&e.posY[i])};
+    __m128 vx{_mm_loadu_ps(&e.velX[i])};
+    __m128 vy{_mm_loadu_ps(&e.velY[i])};
+
+    const __m128 quique{_mm_or_ps(rebater(px, vx, vLimite), rebater(py, vy, vLimite))};
+    _mm_storeu_ps(&e.velX[i], vx);
+    _mm_storeu_ps(&e.velY[i], vy);
+    _mm_storeu_ps(&e.posX[i], _mm_add_ps(px, _mm_mul_ps(vx, vdt)));
+    _mm_storeu_ps(&e.posY[i], _mm_add_ps(py, _mm_mul_ps(vy, vdt)));
+
+    girar(&e.angX[i], &e.velAngX[i], vdt);
+    girar(&e.angY[i], &e.velAngY[i], vdt);
+    girar(&e.angZ[i], &e.velAngZ[i], vdt);
+
+    //decrementa o tempo de giro só dos dados que estão girando; pousa quem estava no último passo
+    auto *passos{reinterpret_cast<__m128i *>(&e.passosRestantes[i])};
+    const __m128i p{_mm_loadu_si128(passos)};
+    const __m128i girando{_mm_cmpgt_epi32(p, zeroInteiro)};
+    const __m128i pouso{_mm_cmpeq_epi32(p, umInteiro)};
+    _mm_storeu_si128(passos, _mm_add_epi32(p, girando));
+
+    if(const int mascara{_mm_movemask_ps(quique)}; mascara != 0) {
+      registrar(eventos.quiques, mascara, i);
+    }
+    if(const int mascara{_mm_movemask_ps(_mm_castsi128_ps(pouso))}; mascara != 0) {
+      registrar(eventos.pousos, mascara, i);
+    }
+  }
+
+  integrarEscalar(e, fimVetorial, n, dt, limite, eventos);
+}
+
+__attribute__((target("avx2"))) inline __m256 rebater(__m256 pos, __m256 &vel, __m256 limite) {
+  const __m256 zero{_mm256_setzero_ps()};
+  const __m256 menosLimite{_mm256_sub_ps(zero, limite)};
+  const __m256 saindoPositivo{_mm256_and_ps(_mm256_cmp_ps(pos, limite, _CMP_GE_OQ),
+                                            _mm256_cmp_ps(vel, zero, _CMP_GT_OQ))};
+  const __m256 saindoNegativo{_mm256_and_ps(_mm256_cmp_ps(pos, menosLimite, _CMP_LE_OQ),
+                                            _mm256_cmp_ps(vel, zero, _CMP_LT_OQ))};
+  const __m256 quique{_mm256_or_ps(saindoPositivo, saindoNegativo)};
+  vel = _mm256_xor_ps(vel, _mm256_and_ps(quique, _mm256_set1_ps(-0.0f)));
+  return quique;
+}
+
+__attribute__((target("avx2"))) inline void girar(float *angulo, const float *velocidade, __m256 dt) {
+  const __m256 a{_mm256_add_ps(_mm256_loadu_ps(angulo), _mm256_mul_ps(_mm256_loadu_ps(velocidade), dt))};
+  const __m256 voltas{_mm256_floor_ps(_mm256_mul_ps(a, _mm256_set1_ps(inversoDoisPi)))};
+  _mm256_storeu_ps(angulo, _mm256_sub_ps(a, _mm256_mul_ps(voltas, _mm256_set1_ps(doisPi))));
+}
+
+__attribute__((target("avx2"))) void integrarAVX2(DiceState &e, std::size_t n, float dt, float limite,
+                                                  EventosPasso &eventos) {
+  const std::size_t fimVetorial{n - n % 8};
+
+  const __m256 vdt{_mm256_set1_ps(dt)};
+  const __m256 vLimite{_mm256_set1_ps(limite)};
+  const __m256i umInteiro{_mm256_set1_epi32(1)};
+  const __m256i zeroInteiro{_mm256_setzero_si256()};
+
+  for(std::size_t i{0}; i < fimVetorial; i += 8) {
+    const __m256 px{_mm256_loadu_ps(&e.posX[i])};
+    const __m256 py{_mm256_loadu_ps(&e.posY[i])};
+    __m256 vx{_mm256_loadu_ps(&e.velX[i])};
+    __m256 vy{_mm256_loadu_ps(&e.velY[i])};
+
+    const __m256 quique{_mm256_or_ps(rebater(px, vx, vLimite), rebater(py, vy, vLimite))};
+    _mm256_storeu_ps(&e.velX[i], vx);
+    _mm256_storeu_ps(&e.velY[i], vy);
+    _mm256_storeu_ps(&e.posX[i], _mm256_add_ps(px, _mm256_mul_ps(vx, vdt)));
+    _mm256_storeu_ps(&e.posY[i], _mm256_add_ps(py, _mm256_mul_ps(vy, vdt)));
+
+    girar(&e.angX[i], &e.velAngX[i], vdt);
+    girar(&e.angY[i], &e.velAngY[i], vdt);
+    girar(&e.angZ[i], &e.velAngZ[i], vdt);
+
+    auto *passos{reinterpret_cast<__m256i *>(&e.passosRestantes[i])};
+    const __m256i p{_mm256_loadu_si256(passos)};
+    const __m256i girando{_mm256_cmpgt_epi32(p, zeroInteiro)};
+    const __m256i pouso{_mm256_cmpeq_epi32(p, umInteiro)};
+    _mm256_storeu_si256(passos, _mm256_add_epi32(p, girando));
+
+    if(const int mascara{_mm256_movemask_ps(quique)}; mascara != 0) {
+      registrar(eventos.quiques, mascara, i);
+    }
+    if(const int mascara{_mm256_movemask_ps(_mm256_castsi256_ps(pouso))}; mascara != 0) {
+      registrar(eventos.pousos, mascara, i);
+    }
+  }
+
+  integrarEscalar(e, fimVetorial, n, dt, limite, eventos);
+}
+#endif
+}  // namespace
+
+KernelIntegracao melhorKernel() {
+#if defined(DICE_SIMD_X86)
+  if(__builtin_cpu_supports("avx2")) return KernelIntegracao::AVX2;
+  if(__builtin_cpu_supports("sse4.1")) return KernelIntegracao::SSE41;
+#endif
+  return KernelIntegracao::Escalar;
+}
+
+const char *nomeKernel(KernelIntegracao kernel) {
+  switch(kernel) {
+    case KernelIntegracao::AVX2: return "AVX2";
+    case KernelIntegracao::SSE41: return "SSE4.1";
+    default: return "escalar";
+  }
+}
+
+void integrarPasso(DiceState &estado, std::size_t quantidade, float dt, float limite, EventosPasso &eventos) {
+  static const KernelIntegracao kernel{melhorKernel()};
+  integrarPasso(estado, quantidade, dt, limite, eventos, kernel);
+}
+
+void integrarPasso(DiceState &estado, std::size_t quantidade, float dt, float limite, EventosPasso &eventos,
+                   KernelIntegracao kernel) {
+  eventos.quiques.clear();
+  eventos.pousos.clear();
+
+#if defined(DICE_SIMD_X86)
+  if(kernel == KernelIntegracao::AVX2) {
+    integrarAVX2(estado, quantidade, dt, limite, eventos);
+    return;
+  }
+  if(kernel == KernelIntegracao::SSE41) {
+    integrarSSE41(estado, quantidade, dt, limite, eventos);
+    return;
+  }
+#endif
+  integrarEscalar(estado, 0, quantidade, dt, limite, eventos);
+}
@@ -0,0 +1,27 @@
+#ifndef INTEGRATION_HPP_
+#define INTEGRATION_HPP_
+
+#include <cstdint>
+#include <vector>
+
+#include "dicestate.hpp"
+
+//dados que precisam de tratamento escalar depois do passo vetorizado
+struct EventosPasso {
+  std::vector<std::uint32_t> quiques; //bateram numa parede da mesa e tiveram a direção invertida
+  std::vector<std::uint32_t> pousos; //terminaram o tempo de giro neste passo
+};
+
+enum class KernelIntegracao { Escalar, SSE41, AVX2 };
+
+//kernel mais rápido suportado pelo processador em execução
+[[nodiscard]] KernelIntegracao melhorKernel();
+[[nodiscard]] const char *nomeKernel(KernelIntegracao kernel);
+
+//avança os dados [0, quantidade) em dt segundos: rebate nas paredes em ±limite, desloca, gira e decrementa
+//o tempo de giro. Não sorteia nada; os dados que quicaram ou pousaram são listados em eventos
+void integrarPasso(DiceState &estado, std::size_t quantidade, float dt, float limite, EventosPasso &eventos);
+void integrarPasso(DiceState &estado, std::size_t quantidade, float dt, float limite, EventosPasso &eventos,
+                   KernelIntegracao kernel);
+
+#endif
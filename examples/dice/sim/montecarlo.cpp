@@ -0,0 +1,68 @@
+#include "montecarlo.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "simulation.hpp"
+
+namespace {
+//dados simulados juntos numa mesma mesa: grande o bastante para o kernel vetorizado render,
+//pequeno o bastante para haver lotes de sobra para o roubo de tarefas equilibrar as threads
+constexpr std::uint64_t dadosPorLote{1024};
+
+//histograma por thread numa linha de cache própria, para as threads não invalidarem a cache umas das outras
+struct alignas(64) HistogramaLocal {
+  HistogramaFaces faces;
+};
+} // namespace
+
+std::uint64_t HistogramaFaces::total() const {
+  std::uint64_t soma{0};
+  for(std::size_t face{1}; face < contagem.size(); ++face) soma += contagem[face];
+  return soma;
+}
+
+double HistogramaFaces::quiQuadrado() const {
+  const auto esperado{static_cast<double>(total()) / 6.0};
+  if(esperado == 0.0) return 0.0;
+
+  double soma{0.0};
+  for(std::size_t face{1}; face < contagem.size(); ++face) {
+    const auto diferenca{static_cast<double>(contagem[face]) - esperado};
+    soma += diferenca * diferenca / esperado;
+  }
+  return soma;
+}
+
+HistogramaFaces &HistogramaFaces::operator+=(const HistogramaFaces &outro) {
+  for(std::size_t face{0}; face < contagem.size(); ++face) contagem[face] += outro.contagem[face];
+  return *this;
+}
+
+HistogramaFaces lancarEmLote(WorkStealingPool &pool, std::uint64_t lancamentos, std::uint64_t semente) {
+  const auto lotes{(lancamentos + dadosPorLote - 1) / dadosPorLote};
+
+  std::vector<HistogramaLocal> histogramas(pool.size());
+  //uma mesa por thread, reaproveitada entre lotes para não realocar os arranjos
+  std::vector<DiceSimulation> mesas(pool.size());
+  for(auto &mesa : mesas) mesa.habilitarColisoes(false); //lançamentos independentes não se tocam
+
+  pool.paraCada(lotes, [&](std::size_t lote, unsigned thread) {
+    const auto inicio{lote * dadosPorLote};
+    const auto quantidade{std::min(dadosPorLote, lancamentos - inicio)};
+
+    auto &mesa{mesas[thread]};
+    //cada lançamento é o dado de número `inicio + index` na sequência da semente: o sorteio não depende
+    //de qual thread executou o lote, nem do tamanho do lote
+    mesa.reset(quantidade, semente, static_cast<std::uint32_t>(inicio));
+    mesa.jogarDados();
+    for(auto passos{mesa.passosAtePousar()}; passos > 0; --passos) mesa.passo();
+
+    auto &faces{histogramas[thread].faces};
+    for(std::size_t index{0}; index < mesa.size(); ++index) ++faces.contagem[mesa.face(index)];
+  });
+
+  HistogramaFaces resultado;
+  for(const auto &local : histogramas) resultado += local.faces;
+  return resultado;
+}
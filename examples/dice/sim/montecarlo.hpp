@@ -0,0 +1,27 @@
+#ifndef MONTECARLO_HPP_
+#define MONTECARLO_HPP_
+
+#include <array>
+#include <cstdint>
+
+#include "threadpool.hpp"
+
+//contagem de faces de um lote de lançamentos; o índice 0 não é usado, para manter face == índice
+struct HistogramaFaces {
+  std::array<std::uint64_t, 7> contagem{};
+
+  [[nodiscard]] std::uint64_t total() const;
+  //qui-quadrado contra o dado honesto (5 graus de liberdade; abaixo de 11,07 não se rejeita a 5%)
+  [[nodiscard]] double quiQuadrado() const;
+
+  HistogramaFaces &operator+=(const HistogramaFaces &outro);
+};
+
+//lança `lancamentos` dados independentes com a simulação completa (giro, deslocamento, quiques e pouso),
+//espalhados pelas threads do pool. Cada lançamento sorteia pelo contador (semente, número do lançamento)
+//do gerador Philox, sem estado compartilhado, e cada thread acumula num histograma próprio, somado só no final:
+//o resultado depende apenas da semente, não de quantas threads há nem de qual thread roubou qual lote
+//os lançamentos são numerados com 32 bits, então um lote vai até 2^32 lançamentos
+HistogramaFaces lancarEmLote(WorkStealingPool &pool, std::uint64_t lancamentos, std::uint64_t semente);
+
+#endif
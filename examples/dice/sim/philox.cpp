@@ -0,0 +1,141 @@
+#include "philox.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__)) && \
+    !defined(__EMSCRIPTEN__)
+#define DICE_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+using namespace philox;
+
+void philoxEscalar(std::uint64_t semente, std::uint32_t primeiroDado, const std::uint32_t *dados,
+                   const std::uint32_t *lancamentos,
+                   std::uint32_t bloco, std::size_t inicio, std::size_t fim,
+                   const std::array<std::uint32_t *, 4> &saida) {
+  for(auto i{inicio}; i < fim; ++i) {
+    const auto palavras{philox4x32({primeiroDado + dados[i], lancamentos[i], bloco, 0}, semente)};
+    for(std::size_t k{0}; k < palavras.size(); ++k) saida[k][i] = palavras[k];
+  }
+}
+
+#if defined(DICE_SIMD_X86)
+//produto de 32x32 bits em cada faixa: _mm_mul_epu32 só multiplica as faixas pares,
+//então as ímpares são deslocadas para as posições pares e os resultados intercalados de volta
+__attribute__((target("sse4.1"))) inline void multiplicar(__m128i a, __m128i m, __m128i &alto, __m128i &baixo) {
+  const __m128i pares{_mm_mul_epu32(a, m)};
+  const __m128i impares{_mm_mul_epu32(_mm_srli_epi64(a, 32), m)};
+  baixo = _mm_blend_epi16(pares, _mm_slli_epi64(impares, 32), 0xCC);
+  alto = _mm_blend_epi16(_mm_srli_epi64(pares, 32), impares, 0xCC);
+}
+
+__attribute__((target("sse4.1"))) void philoxSSE41(std::uint64_t semente, std::uint32_t primeiroDado,
+                                                     const std::uint32_t *dados, const std::uint32_t *lancamentos, std::uint32_t bloco,
+                                                     std::size_t quantidade,
+                                                     const std::array<std::uint32_t *, 4> &saida) {
+  const std::size_t fimVetorial{quantidade - quantidade % 4};
+  const __m128i m0{_mm_set1_epi32(static_cast<int>(multiplicador0))};
+  const __m128i m1{_mm_set1_epi32(static_cast<int>(multiplicador1))};
+  const __m128i primeiro{_mm_set1_epi32(static_cast<int>(primeiroDado))};
+
+  for(std::size_t i{0}; i < fimVetorial; i += 4) {
+    __m128i c0{_mm_add_epi32(primeiro, _mm_loadu_si128(reinterpret_cast<const __m128i *>(dados + i)))};
+    __m128i c1{_mm_loadu_si128(reinterpret_cast<const __m128i *>(lancamentos + i))};
+    __m128i c2{_mm_set1_epi32(static_cast<int>(bloco))};
+    __m128i c3{_mm_setzero_si128()};
+
+    auto chave0{static_cast<std::uint32_t>(semente)};
+    auto chave1{static_cast<std::uint32_t>(semente >> 32)};
+    for(int rodada{0}; rodada < 10; ++rodada) {
+      __m128i alto0, baixo0, alto1, baixo1;
+      multiplicar(c0, m0, alto0, baixo0);
+      multiplicar(c2, m1, alto1, baixo1);
+      c0 = _mm_xor_si128(_mm_xor_si128(alto1, c1), _mm_set1_epi32(static_cast<int>(chave0)));
+      c1 = baixo1;
+      c2 = _mm_xor_si128(_mm_xor_si128(alto0, c3), _mm_set1_epi32(static_cast<int>(chave1)));
+      c3 = baixo0;
+      chave0 += incremento0;
+      chave1 += incremento1;
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(saida[0] + i), c0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(saida[1] + i), c1);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(saida[2] + i), c2);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(saida[3] + i), c3);
+  }
+
+  philoxEscalar(semente, primeiroDado, dados, lancamentos, bloco, fimVetorial, quantidade, saida);
+}
+
+__attribute__((target("avx2"))) inline void multiplicar(__m256i a, __m256i m, __m256i &alto, __m256i &baixo) {
+  const __m256i pares{_mm256_mul_epu32(a, m)};
+  const __m256i impares{_mm256_mul_epu32(_mm256_srli_epi64(a, 32), m)};
+  baixo = _mm256_blend_epi32(pares, _mm256_slli_epi64(impares, 32), 0xAA);
+  alto = _mm256_blend_epi32(_mm256_srli_epi64(pares, 32), impares, 0xAA);
+}
+
+__attribute__((target("avx2"))) void philoxAVX2(std::uint64_t semente, std::uint32_t primeiroDado,
+                                                  const std::uint32_t *dados, const std::uint32_t *lancamentos, std::uint32_t bloco,
+                                                  std::size_t quantidade,
+                                                  const std::array<std::uint32_t *, 4> &saida) {
+  const std::size_t fimVetorial{quantidade - quantidade % 8};
+  const __m256i m0{_mm256_set1_epi32(static_cast<int>(multiplicador0))};
+  const __m256i m1{_mm256_set1_epi32(static_cast<int>(multiplicador1))};
+  const __m256i primeiro{_mm256_set1_epi32(static_cast<int>(primeiroDado))};
+
+  for(std::size_t i{0}; i < fimVetorial; i += 8) {
+    __m256i c0{_mm256_add_epi32(primeiro, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dados + i)))};
+    __m256i c1{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(lancamentos + i))};
+    __m256i c2{_mm256_set1_epi32(static_cast<int>(bloco))};
+    __m256i c3{_mm256_setzero_si256()};
+
+    auto chave0{static_cast<std::uint32_t>(semente)};
+    auto chave1{static_cast<std::uint32_t>(semente >> 32)};
+    for(int rodada{0}; rodada < 10; ++rodada) {
+      __m256i alto0, baixo0, alto1, baixo1;
+      multiplicar(c0, m0, alto0, baixo0);
+      multiplicar(c2, m1, alto1, baixo1);
+      c0 = _mm256_xor_si256(_mm256_xor_si256(alto1, c1), _mm256_set1_epi32(static_cast<int>(chave0)));
+      c1 = baixo1;
+      c2 = _mm256_xor_si256(_mm256_xor_si256(alto0, c3), _mm256_set1_epi32(static_cast<int>(chave1)));
+      c3 = baixo0;
+      chave0 += incremento0;
+      chave1 += incremento1;
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(saida[0] + i), c0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(saida[1] + i), c1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(saida[2] + i), c2);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(saida[3] + i), c3);
+  }
+
+  philoxEscalar(semente, primeiroDado, dados, lancamentos, bloco, fimVetorial, quantidade, saida);
+}
+#endif
+}  // namespace
+
+void philoxEmLote(std::uint64_t semente, std::uint32_t primeiroDado, const std::uint32_t *dados,
+                  const std::uint32_t *lancamentos,
+                  std::uint32_t bloco, std::size_t quantidade, const std::array<std::uint32_t *, 4> &saida) {
+  static const KernelIntegracao kernel{melhorKernel()};
+  philoxEmLote(semente, primeiroDado, dados, lancamentos, bloco, quantidade, saida, kernel);
+}
+
+void philoxEmLote(std::uint64_t semente, std::uint32_t primeiroDado, const std::uint32_t *dados,
+                  const std::uint32_t *lancamentos,
+                  std::uint32_t bloco, std::size_t quantidade, const std::array<std::uint32_t *, 4> &saida,
+                  KernelIntegracao kernel) {
+#if defined(DICE_SIMD_X86)
+  if(kernel == KernelIntegracao::AVX2) {
+    philoxAVX2(semente, primeiroDado, dados, lancamentos, bloco, quantidade, saida);
+    return;
+  }
+  if(kernel == KernelIntegracao::SSE41) {
+    philoxSSE41(semente, primeiroDado, dados, lancamentos, bloco, quantidade, saida);
+    return;
+  }
+#else
+  (void)kernel;
+#endif
+  philoxEscalar(semente, primeiroDado, dados, lancamentos, bloco, 0, quantidade, saida);
+}
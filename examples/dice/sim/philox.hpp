@@ -0,0 +1,63 @@
+#ifndef PHILOX_HPP_
+#define PHILOX_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "integration.hpp"
+
+//gerador baseado em contador Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", 2011):
+//cada bloco de 4 palavras é uma função pura de (semente, contador), sem estado a avançar. Qualquer sorteio
+//pode ser refeito em O(1) a partir do seu contador, e threads diferentes nunca compartilham gerador
+using BlocoPhilox = std::array<std::uint32_t, 4>;
+
+namespace philox {
+inline constexpr std::uint32_t multiplicador0{0xD2511F53};
+inline constexpr std::uint32_t multiplicador1{0xCD9E8D57};
+inline constexpr std::uint32_t incremento0{0x9E3779B9}; //somados à chave a cada rodada
+inline constexpr std::uint32_t incremento1{0xBB67AE85};
+}  // namespace philox
+
+[[nodiscard]] constexpr BlocoPhilox philox4x32(BlocoPhilox contador, std::uint64_t semente) {
+  using namespace philox;
+
+  auto chave0{static_cast<std::uint32_t>(semente)};
+  auto chave1{static_cast<std::uint32_t>(semente >> 32)};
+  for(int rodada{0}; rodada < 10; ++rodada) {
+    const std::uint64_t produto0{std::uint64_t{multiplicador0} * contador[0]};
+    const std::uint64_t produto1{std::uint64_t{multiplicador1} * contador[2]};
+    contador = {static_cast<std::uint32_t>(produto1 >> 32) ^ contador[1] ^ chave0,
+                static_cast<std::uint32_t>(produto1),
+                static_cast<std::uint32_t>(produto0 >> 32) ^ contador[3] ^ chave1,
+                static_cast<std::uint32_t>(produto0)};
+    chave0 += incremento0;
+    chave1 += incremento1;
+  }
+  return contador;
+}
+
+//converte uma palavra sorteada em float uniforme em [minimo, maximo), com 24 bits de mantissa
+[[nodiscard]] constexpr float uniforme(std::uint32_t palavra, float minimo, float maximo) {
+  return minimo + (maximo - minimo) * static_cast<float>(palavra >> 8) * (1.0f / 16777216.0f);
+}
+
+//converte uma palavra sorteada em inteiro uniforme em [minimo, maximo] por multiplicação (viés < 2^-32 por valor).
+//ao contrário das distribuições da biblioteca padrão, o resultado é o mesmo em qualquer compilador
+[[nodiscard]] constexpr int inteiro(std::uint32_t palavra, int minimo, int maximo) {
+  const auto faixa{static_cast<std::uint64_t>(maximo - minimo) + 1};
+  return minimo + static_cast<int>((palavra * faixa) >> 32);
+}
+
+//gera em lote os blocos de contador {primeiroDado + dados[i], lancamentos[i], bloco, 0}, i em [0, quantidade),
+//gravando a palavra k do bloco i em saida[k][i]. Os kernels vetorizados processam 4 ou 8 dados por instrução
+//e produzem exatamente os mesmos blocos que philox4x32
+void philoxEmLote(std::uint64_t semente, std::uint32_t primeiroDado, const std::uint32_t *dados,
+                  const std::uint32_t *lancamentos,
+                  std::uint32_t bloco, std::size_t quantidade, const std::array<std::uint32_t *, 4> &saida);
+void philoxEmLote(std::uint64_t semente, std::uint32_t primeiroDado, const std::uint32_t *dados,
+                  const std::uint32_t *lancamentos,
+                  std::uint32_t bloco, std::size_t quantidade, const std::array<std::uint32_t *, 4> &saida,
+                  KernelIntegracao kernel);
+
+#endif
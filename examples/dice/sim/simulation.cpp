@@ -0,0 +1,337 @@
+#include "simulation.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/vec2.hpp>
+
+void DiceSimulation::reset(std::size_t quantity){
+  // Inicializar gerador de números pseudo-aleatórios
+  auto seed{std::chrono::steady_clock::now().time_since_epoch().count()};
+  reset(quantity, static_cast<std::uint64_t>(seed));
+}
+
+void DiceSimulation::reset(std::size_t quantity, std::uint64_t semente, std::uint32_t primeiroDado){
+  m_semente = semente;
+  m_primeiroDado = primeiroDado;
+
+  m_acumulador = 0.0;
+  m_estado.resize(quantity);
+  m_dados.limpar(quantity);
+  m_acordados = 0;
+  m_proximoId = static_cast<std::uint32_t>(quantity);
+
+  for(std::size_t index{0}; index < quantity; ++index) {
+    m_estado.id[index] = static_cast<std::uint32_t>(index);
+    inicializarDado(index);
+  }
+  m_estado.salvarAnterior(quantity);
+  reconstruirGrade();
+}
+
+void DiceSimulation::redimensionar(std::size_t quantity){
+  auto &e{m_estado};
+  const auto anterior{e.size()};
+  //remover o último dado não move nenhum outro, e os acordados continuam antes dos que dormem
+  for(auto index{anterior}; index > quantity; --index) {
+    m_dados.remover(m_dados.handle(index - 1));
+  }
+  e.redimensionar(quantity);
+  m_acordados = std::min(m_acordados, quantity);
+
+  for(auto index{anterior}; index < quantity; ++index) {
+    m_dados.inserir();
+    criarDado(index);
+  }
+  reconstruirGrade();
+}
+
+//o dado novo dorme, então entra depois de todos os outros sem trocar ninguém de lugar
+DiceHandle DiceSimulation::adicionar(){
+  const auto index{m_estado.size()};
+  m_estado.redimensionar(index + 1);
+  criarDado(index);
+  marcarAlterado(index);
+  if(m_colisoes) {
+    m_grade.insert(static_cast<std::uint32_t>(index), {m_estado.posX[index], m_estado.posY[index]});
+  }
+  return m_dados.inserir();
+}
+
+//um dado acordado é antes trocado com o último acordado e posto para dormir, para que a troca com o último
+//dado da mesa não traga um dado dormindo para o meio dos acordados
+bool DiceSimulation::remover(DiceHandle dado){
+  const auto indice{m_dados.indice(dado)};
+  if(!indice) return false;
+  if(*indice < m_acordados) {
+    trocar(*indice, --m_acordados);
+  }
+
+  const auto remocao{m_dados.remover(dado)};
+
+  if(m_colisoes) {
+    m_grade.remove(remocao->indice);
+    m_grade.renumber(remocao->ultimo, remocao->indice);
+  }
+  m_estado.removerTrocandoComOUltimo(remocao->indice);
+  if(remocao->indice < m_estado.size()) marcarAlterado(remocao->indice);
+  return true;
+}
+
+void DiceSimulation::trocar(std::size_t a, std::size_t b){
+  if(a == b) return;
+  m_estado.trocar(a, b);
+  m_dados.trocar(static_cast<std::uint32_t>(a), static_cast<std::uint32_t>(b));
+  if(m_colisoes) m_grade.swap(static_cast<std::uint32_t>(a), static_cast<std::uint32_t>(b));
+}
+
+//o dado vai para o fim dos acordados; o dado que dormia ali fica com o índice antigo dele
+void DiceSimulation::acordar(std::size_t index){
+  if(index < m_acordados) return;
+  trocar(index, m_acordados);
+  marcarAlterado(index);
+  ++m_acordados;
+}
+
+//dados que pousaram no passo anterior já tiveram a pose final copiada para a anterior e podem dormir:
+//enquanto ninguém os jogar, pose e pose anterior não mudam mais
+void DiceSimulation::adormecerPousados(){
+  auto &e{m_estado};
+  for(std::size_t index{0}; index < m_acordados;){
+    if(e.passosRestantes[index] > 0) {
+      ++index;
+      continue;
+    }
+    trocar(index, --m_acordados);
+    marcarAlterado(m_acordados);
+  }
+}
+
+void DiceSimulation::marcarAlterado(std::size_t index){
+  if(m_tudoAlterado) return;
+  //sem ninguém lendo a lista (um servidor, por exemplo), ela não cresce além da quantidade de dados
+  if(m_alterados.size() >= m_estado.size()) {
+    m_tudoAlterado = true;
+    m_alterados.clear();
+    return;
+  }
+  m_alterados.push_back(static_cast<std::uint32_t>(index));
+}
+
+void DiceSimulation::limparAlterados(){
+  m_alterados.clear();
+  m_tudoAlterado = false;
+}
+
+void DiceSimulation::reservar(std::size_t capacidade){
+  m_estado.reserve(capacidade);
+  m_dados.reserve(capacidade);
+  m_grade.reserve(capacidade);
+  //marcarAlterado nunca deixa a lista passar da quantidade de dados
+  m_alterados.reserve(capacidade);
+}
+
+//dado novo, com um id que a mesa ainda não usou; aparece parado, sem nada para interpolar
+void DiceSimulation::criarDado(std::size_t index){
+  auto &e{m_estado};
+  e.id[index] = m_proximoId++;
+  inicializarDado(index);
+  e.posXAnterior[index] = e.posX[index];
+  e.posYAnterior[index] = e.posY[index];
+  e.angXAnterior[index] = e.angX[index];
+  e.angYAnterior[index] = e.angY[index];
+  e.angZAnterior[index] = e.angZ[index];
+}
+
+void DiceSimulation::definirEscala(float escala){
+  m_escala = escala;
+  m_distanciaColisao = 1.2f * m_escala;
+  reconstruirGrade();
+}
+
+//refaz a grade com todos os dados, com células do tamanho da distância de colisão atual
+void DiceSimulation::reconstruirGrade(){
+  const auto quantidade{m_estado.size()};
+  m_tudoAlterado = true;
+  m_alterados.clear();
+  m_grade.reset(m_distanciaColisao, m_colisoes ? quantidade : 0);
+
+  if(!m_colisoes) return;
+  for(std::size_t index{0}; index < quantidade; ++index) {
+    m_grade.insert(static_cast<std::uint32_t>(index), {m_estado.posX[index], m_estado.posY[index]});
+  }
+}
+
+//avança a simulação em passos fixos de passoFixo segundos, independentemente da taxa de quadros.
+//o tempo que sobra no acumulador é usado para interpolar entre os dois últimos estados na renderização
+void DiceSimulation::update(double deltaTime){
+  //limita o tempo de um quadro muito lento para não acumular passos indefinidamente
+  m_acumulador += std::min(deltaTime, m_maxTempoQuadro);
+
+  while(m_acumulador >= passoFixo){
+    passo();
+    m_acumulador -= passoFixo;
+  }
+}
+
+//um passo de simulação de passoFixo segundos para os dados acordados; os que dormem não mudam
+void DiceSimulation::passo(){
+  auto &e{m_estado};
+  //quem dorme já tem pose anterior igual à atual
+  e.salvarAnterior(m_acordados);
+  adormecerPousados();
+
+  //colisões entre dados: só quem está girando procura vizinhos, mas os que dormem continuam na grade como obstáculos
+  if(m_colisoes){
+    for(std::size_t index{0}; index < m_acordados; ++index){
+      checkCollisions(index);
+    }
+  }
+
+  //quique nas paredes, deslocamento, giro e contagem do tempo de giro, vários dados por instrução
+  integrarPasso(e, m_acordados, static_cast<float>(passoFixo), limiteMesa, m_eventos);
+
+  //ao bater numa parede o dado sorteia novas velocidades, mantendo o sentido que o quique definiu
+  //cada quique consome o próximo bloco de velocidades do lançamento
+  for(const auto index : m_eventos.quiques){
+    velocidadesAleatorias(index, sortear(index, ++e.sorteios[index]));
+  }
+  //podemos finalizar o giro do dado e parar num número aleatório
+  for(const auto index : m_eventos.pousos){
+    pousarDado(index);
+  }
+
+  //só dados que mudaram de célula mexem na grade
+  if(!m_colisoes) return;
+  for(std::size_t index{0}; index < m_acordados; ++index){
+    if(e.posX[index] != e.posXAnterior[index] || e.posY[index] != e.posYAnterior[index]){
+      m_grade.update(static_cast<std::uint32_t>(index), {e.posX[index], e.posY[index]});
+    }
+  }
+}
+
+BlocoPhilox DiceSimulation::sortear(std::size_t index, std::uint32_t bloco) const {
+  const auto dado{m_primeiroDado + m_estado.id[index]};
+  return philox4x32({dado, m_estado.lancamento[index], bloco, 0}, m_semente);
+}
+
+int DiceSimulation::faceDoLancamento(std::uint64_t semente, std::uint32_t dado, std::uint32_t lancamento){
+  return inteiro(philox4x32({dado, lancamento, 0, 0}, semente)[0], 1, 6);
+}
+
+//função para começar o dado numa posição e número aleatório, além de inicializar algumas outras variáveis necessárias.
+//a posição inicial usa o bloco 0 do lançamento 0; a face vem da mesma palavra que faceDoLancamento lê
+void DiceSimulation::inicializarDado(std::size_t index) {
+  m_estado.lancamento[index] = 0;
+  m_estado.sorteios[index] = 0;
+  const auto palavras{sortear(index, 0)};
+  m_estado.posX[index] = uniforme(palavras[1], -limiteMesa, limiteMesa);
+  m_estado.posY[index] = uniforme(palavras[2], -limiteMesa, limiteMesa);
+  pousarDado(index); //começar num numero aleatorio
+}
+
+//sorteia os blocos de todos os dados de uma vez, pelo caminho vetorizado do gerador
+void DiceSimulation::jogarDados(){
+  auto &e{m_estado};
+  const auto quantidade{e.size()};
+  for(auto &palavras : m_palavras) palavras.resize(quantidade * 2);
+  const std::array<std::uint32_t *, 4> lancamentos{m_palavras[0].data(), m_palavras[1].data(),
+                                                   m_palavras[2].data(), m_palavras[3].data()};
+  const std::array<std::uint32_t *, 4> velocidades{m_palavras[0].data() + quantidade, m_palavras[1].data() + quantidade,
+                                                   m_palavras[2].data() + quantidade, m_palavras[3].data() + quantidade};
+
+  //todos acordam; a ordem dos dados não muda
+  m_acordados = quantidade;
+  for(std::size_t index{0}; index < quantidade; ++index) ++e.lancamento[index];
+  philoxEmLote(m_semente, m_primeiroDado, e.id.data(), e.lancamento.data(), 0, quantidade, lancamentos);
+  philoxEmLote(m_semente, m_primeiroDado, e.id.data(), e.lancamento.data(), 1, quantidade, velocidades);
+
+  for(std::size_t index{0}; index < quantidade; ++index){
+    arremessarDado(index, {lancamentos[0][index], lancamentos[1][index], lancamentos[2][index], lancamentos[3][index]},
+                   {velocidades[0][index], velocidades[1][index], velocidades[2][index], velocidades[3][index]});
+  }
+}
+
+std::int32_t DiceSimulation::passosAtePousar() const{
+  //quem dorme tem zero passos restantes
+  const auto passos{m_estado.passosRestantes.begin()};
+  return m_acordados == 0 ? 0 : *std::max_element(passos, passos + static_cast<std::ptrdiff_t>(m_acordados));
+}
+
+bool DiceSimulation::jogarDado(DiceHandle dado){
+  if(!m_dados.indice(dado)) return false;
+  acordar(*m_dados.indice(dado));
+  const auto index{*m_dados.indice(dado)};
+  ++m_estado.lancamento[index];
+  arremessarDado(index, sortear(index, 0), sortear(index, 1));
+  return true;
+}
+
+//bloco 0 do lançamento: palavra 0 = face do pouso (lida só em pousarDado), 1 = tempo de giro, 2 = sentidos iniciais.
+//bloco 1: velocidades do arremesso
+void DiceSimulation::arremessarDado(std::size_t index, const BlocoPhilox &lancamento, const BlocoPhilox &velocidades){
+  auto &e{m_estado};
+  //tempo de giro do dado, algo entre 2 e 5 segundos, contado em passos de simulação
+  const auto passosPorSegundo{static_cast<int>(1.0 / passoFixo)};
+  e.passosRestantes[index] = inteiro(lancamento[1], passosPorSegundo * 2, passosPorSegundo * 5);
+
+  //o sentido inicial de cada eixo é sorteado; velocidadesAleatorias preserva o sinal
+  e.velX[index] = (lancamento[2] & 1u) != 0 ? 1.0f : -1.0f;
+  e.velY[index] = (lancamento[2] & 2u) != 0 ? 1.0f : -1.0f;
+  e.sorteios[index] = 1;
+  velocidadesAleatorias(index, velocidades);
+}
+
+//função para fazer o dado parar numa das faces retas aleatoriamente
+void DiceSimulation::pousarDado(std::size_t index) {
+  //reinicialização de variáveis para podermos parar o dado e jogar novamente
+  auto &e{m_estado};
+  e.passosRestantes[index] = 0;
+  e.velX[index] = e.velY[index] = 0.0f;
+  e.velAngX[index] = e.velAngY[index] = e.velAngZ[index] = 0.0f;
+
+  const int numeroDoDado{faceDoLancamento(m_semente, m_primeiroDado + e.id[index], e.lancamento[index])};
+  e.face[index] = static_cast<std::uint8_t>(numeroDoDado);
+  e.angX[index] = glm::radians(angulosRetos[numeroDoDado].x);
+  e.angY[index] = glm::radians(angulosRetos[numeroDoDado].y);
+}
+
+//sorteia a velocidade angular (só um dos eixos gira, entre 240 e 480 graus por segundo) e a velocidade
+//de deslocamento em cada eixo, em unidades da mesa por segundo, mantendo o sentido atual
+void DiceSimulation::velocidadesAleatorias(std::size_t index, const BlocoPhilox &palavras){
+  const int eixo{inteiro(palavras[0], 0, 2)};
+  const float velocidade{glm::radians(uniforme(palavras[1], 240.0f, 480.0f))};
+
+  auto &e{m_estado};
+  e.velAngX[index] = eixo == 0 ? velocidade : 0.0f;
+  e.velAngY[index] = eixo == 1 ? velocidade : 0.0f;
+  e.velAngZ[index] = eixo == 2 ? velocidade : 0.0f;
+
+  e.velX[index] = std::copysign(uniforme(palavras[2], 3.0f, 6.0f), e.velX[index]);
+  e.velY[index] = std::copysign(uniforme(palavras[3], 3.0f, 6.0f), e.velY[index]);
+}
+
+//verifica se o dado está colidindo com algum outro e, ao começar a colidir, inverte o sentido do movimento.
+//a grade espacial limita a busca aos dados das células vizinhas, e a comparação é feita com a distância ao quadrado
+void DiceSimulation::checkCollisions(std::size_t index) {
+  auto &e{m_estado};
+  const auto self{static_cast<std::uint32_t>(index)};
+  const glm::vec2 position{e.posX[index], e.posY[index]};
+  const float distanciaMinima2{m_distanciaColisao * m_distanciaColisao};
+
+  bool colidindo{false};
+  m_grade.forEachNear(position, [&](std::uint32_t id) {
+    if(id == self) return true;
+    const glm::vec2 diferenca{glm::vec2{e.posX[id], e.posY[id]} - position};
+    colidindo = glm::dot(diferenca, diferenca) < distanciaMinima2;
+    return !colidindo;
+  });
+
+  if(colidindo && e.colidindo[index] == 0) {
+    e.velX[index] = -e.velX[index];
+    e.velY[index] = -e.velY[index];
+  }
+  e.colidindo[index] = colidindo ? 1 : 0;
+}
+
@@ -0,0 +1,132 @@
+#ifndef SIMULATION_HPP_
+#define SIMULATION_HPP_
+
+#include <array>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "dicestate.hpp"
+#include "integration.hpp"
+#include "philox.hpp"
+#include "slotmap.hpp"
+#include "spatialhash.hpp"
+
+//simulação dos dados sem dependência de janela, OpenGL ou ImGui: lançamento, integração em passo fixo,
+//colisões e pouso. A renderização (Dices) só lê o estado; servidores podem rodá-la sem GPU.
+//os dados acordados (girando) ficam em [0, acordados()) e os que dormem (pousados) depois deles: um passo
+//só percorre os acordados, e quem dorme só volta a custar algo ao ser jogado de novo
+class DiceSimulation {
+  public:
+    static constexpr double passoFixo{1.0 / 120.0}; //duração de um passo de simulação, em segundos
+    static constexpr float limiteMesa{1.5f}; //a mesa vai de -limiteMesa a limiteMesa em x e y
+
+    //lista de ângulos cuja face do dado fica virada para a tela. Poderia ser maior, mas o resultado final seria pouco diferente.
+    static constexpr std::array<glm::vec3, 7> angulosRetos{
+      glm::vec3{0.0f,0.0f,0.0f}, //0 apenas pra manter o numero do dado igual ao numero do indice
+      glm::vec3{125.0f,120.0f,45.0f}, //1
+      glm::vec3{345.0f,170.0f,15.0f}, //2
+      glm::vec3{75.0f,190.0f,13.0f}, //3
+      glm::vec3{75.0f,20.0f,77.0f},//4
+      glm::vec3{347.0f,342.0f,75.0f}, //5
+      glm::vec3{105.0f,300.0f,45.0f} //6
+    };
+
+    //recria a mesa com quantity dados parados em posições e faces aleatórias, semeando pelo relógio
+    void reset(std::size_t quantity);
+    //idem, com semente de sessão fixa. Todo sorteio é função de (semente, primeiroDado + id, lançamento), e reset
+    //numera os dados de 0 a quantity - 1, então a mesma semente reproduz os mesmos lançamentos e mesas com faixas
+    //de dados diferentes não se repetem. Todos os handles anteriores deixam de valer
+    void reset(std::size_t quantity, std::uint64_t semente, std::uint32_t primeiroDado = 0);
+    //muda a quantidade de dados sem mexer nos que já estão na mesa, nem no meio de um lançamento.
+    //os que sobram no fim saem da mesa; os novos recebem ids que a mesa ainda não usou
+    void redimensionar(std::size_t quantity);
+
+    //coloca um dado parado numa posição e face aleatórias sem mexer nos demais, em O(1). Até a capacidade
+    //reservada, os arranjos, os handles, as entradas da grade e a lista de alterados não realocam; só o balde da
+    //grade que recebe o dado pode crescer, se passar do maior tamanho que já teve
+    DiceHandle adicionar();
+    //tira o dado da mesa em O(1); o último dado passa a ocupar o índice dele. Retorna false se o handle não vale mais
+    bool remover(DiceHandle dado);
+    //prepara a mesa para receber até capacidade dados sem realocar (ver adicionar)
+    void reservar(std::size_t capacidade);
+    //índice atual do dado nos arranjos de estado(), ou nada se ele já saiu da mesa
+    [[nodiscard]] std::optional<std::uint32_t> indice(DiceHandle dado) const { return m_dados.indice(dado); }
+    [[nodiscard]] DiceHandle handle(std::size_t index) const { return m_dados.handle(index); }
+
+    //avança a simulação em passos fixos; o tempo que sobra fica no acumulador para interpolação
+    void update(double deltaTime);
+    //um passo de simulação de passoFixo segundos
+    void passo();
+
+    void jogarDados();
+    //acorda e joga um dado só; retorna false se o handle não vale mais
+    bool jogarDado(DiceHandle dado);
+
+    //face em que o dado pousa no lançamento indicado (0 = posição inicial), sem simular nada
+    [[nodiscard]] static int faceDoLancamento(std::uint64_t semente, std::uint32_t dado, std::uint32_t lancamento);
+
+    //lançamentos independentes (Monte Carlo) dispensam colisões entre os dados da mesma mesa
+    void habilitarColisoes(bool habilitar) { m_colisoes = habilitar; }
+    //tamanho dos dados (1 = o do jogo); a distância de colisão e as células da grade acompanham. O jogo nunca muda
+    //a escala: mesas densas de benchmark diminuem os dados para que caibam na mesa sem se sobrepor
+    void definirEscala(float escala);
+    //passos de simulação até o último dado que está girando pousar
+    [[nodiscard]] std::int32_t passosAtePousar() const;
+
+    [[nodiscard]] const DiceState &estado() const { return m_estado; }
+    [[nodiscard]] std::size_t size() const { return m_estado.size(); }
+    //quantidade de dados acordados, que ocupam os índices [0, acordados())
+    [[nodiscard]] std::size_t acordados() const { return m_acordados; }
+    //índices de dados dormindo cuja pose mudou, ou que passaram a guardar outro dado, desde limparAlterados.
+    //os acordados mudam a todo passo e não são listados. Se tudoAlterado(), a lista não vale e todos devem ser relidos
+    [[nodiscard]] std::span<const std::uint32_t> alterados() const { return m_alterados; }
+    [[nodiscard]] bool tudoAlterado() const { return m_tudoAlterado; }
+    void limparAlterados();
+    [[nodiscard]] bool girando(std::size_t index) const { return m_estado.passosRestantes[index] > 0; }
+    [[nodiscard]] int face(std::size_t index) const { return m_estado.face[index]; }
+    [[nodiscard]] float escala() const { return m_escala; }
+    [[nodiscard]] std::uint64_t semente() const { return m_semente; }
+    //fração do próximo passo já decorrida, em [0, 1)
+    [[nodiscard]] float alpha() const { return static_cast<float>(m_acumulador / passoFixo); }
+
+  private:
+    static constexpr double m_maxTempoQuadro{0.25}; //quadros mais longos que isso são truncados
+    double m_acumulador{}; //tempo ainda não simulado
+
+    float m_escala{1.0f}; //escala dos dados, ver definirEscala
+    float m_distanciaColisao{1.2f}; //distância entre centros abaixo da qual dois dados colidem
+    SpatialHash m_grade; //fase ampla da detecção de colisões
+    bool m_colisoes{true};
+
+    DiceState m_estado; //estado de simulação de todos os dados, em arranjos separados por grandeza
+    SlotMap m_dados; //handles estáveis dos dados, traduzidos para os índices densos de m_estado
+    std::size_t m_acordados{}; //os dados [0, m_acordados) estão girando ou pousaram no último passo
+    std::vector<std::uint32_t> m_alterados; //ver alterados(); pode ter repetições
+    bool m_tudoAlterado{true};
+    EventosPasso m_eventos; //quiques e pousos do último passo, tratados fora do kernel vetorizado
+
+    std::uint64_t m_semente{}; //chave do gerador Philox
+    std::uint32_t m_primeiroDado{}; //somado ao id de cada dado no contador do gerador
+    std::uint32_t m_proximoId{}; //id do próximo dado a entrar na mesa
+    std::array<std::vector<std::uint32_t>, 4> m_palavras; //blocos sorteados em lote por jogarDados
+
+    //bloco do contador {dado, lançamento, bloco, 0}: o bloco 0 decide o lançamento, os seguintes as velocidades
+    [[nodiscard]] BlocoPhilox sortear(std::size_t index, std::uint32_t bloco) const;
+
+    void inicializarDado(std::size_t index);
+    void criarDado(std::size_t index);
+    void trocar(std::size_t a, std::size_t b);
+    void acordar(std::size_t index);
+    void adormecerPousados();
+    void marcarAlterado(std::size_t index);
+    void reconstruirGrade();
+    void pousarDado(std::size_t index);
+    void arremessarDado(std::size_t index, const BlocoPhilox &lancamento, const BlocoPhilox &velocidades);
+    void velocidadesAleatorias(std::size_t index, const BlocoPhilox &palavras);
+    void checkCollisions(std::size_t index);
+};
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef SLOTMAP_HPP_
+#define SLOTMAP_HPP_
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+//referência estável a um dado: continua válida enquanto o dado existir, mesmo que outros entrem e saiam da mesa.
+//a geração muda toda vez que a vaga é liberada, então um handle de um dado removido nunca acha o dado que reusou a vaga
+struct DiceHandle {
+  std::uint32_t slot{};
+  std::uint32_t geracao{};
+
+  friend bool operator==(const DiceHandle &, const DiceHandle &) = default;
+};
+
+//mapa de vagas com geração: traduz handles estáveis para índices densos nos arranjos da simulação e vice-versa.
+//os dados ficam compactados em [0, size()); remover troca o removido pelo último, então só um índice muda por remoção.
+//vagas livres formam uma pilha e são reusadas antes de criar novas, de forma que inserir e remover custam O(1)
+//e não alocam depois de reservar
+class SlotMap {
+  public:
+    struct Remocao {
+      std::uint32_t indice{}; //índice denso que ficou vago
+      std::uint32_t ultimo{}; //índice denso do dado que foi movido para lá (igual a indice se ele era o último)
+    };
+
+    [[nodiscard]] std::size_t size() const { return m_vagaDoIndice.size(); }
+
+    void reserve(std::size_t capacidade) {
+      m_vagas.reserve(capacidade);
+      m_livres.reserve(capacidade);
+      m_vagaDoIndice.reserve(capacidade);
+    }
+
+    //descarta todos os handles e cria quantidade dados nos índices [0, quantidade)
+    void limpar(std::size_t quantidade) {
+      for(auto &vaga : m_vagas) {
+        if(vaga.ocupada) liberar(vaga);
+      }
+      m_livres.clear();
+      for(auto slot{static_cast<std::uint32_t>(m_vagas.size())}; slot-- > 0;) m_livres.push_back(slot);
+      m_vagaDoIndice.clear();
+      while(size() < quantidade) inserir();
+    }
+
+    //ocupa uma vaga para o dado de índice size(); o chamador acrescenta o dado ao fim dos arranjos
+    DiceHandle inserir() {
+      std::uint32_t slot{};
+      if(m_livres.empty()) {
+        slot = static_cast<std::uint32_t>(m_vagas.size());
+        m_vagas.emplace_back();
+      } else {
+        slot = m_livres.back();
+        m_livres.pop_back();
+      }
+      auto &vaga{m_vagas[slot]};
+      vaga.indice = static_cast<std::uint32_t>(size());
+      vaga.ocupada = true;
+      m_vagaDoIndice.push_back(slot);
+      return {slot, vaga.geracao};
+    }
+
+    //libera a vaga do handle e move o último dado para o índice que ficou vago; o chamador faz o mesmo nos arranjos
+    std::optional<Remocao> remover(DiceHandle handle) {
+      const auto indice{this->indice(handle)};
+      if(!indice) return std::nullopt;
+
+      const Remocao remocao{*indice, static_cast<std::uint32_t>(size() - 1)};
+      const auto movido{m_vagaDoIndice[remocao.ultimo]};
+      m_vagaDoIndice[remocao.indice] = movido;
+      m_vagas[movido].indice = remocao.indice;
+      m_vagaDoIndice.pop_back();
+
+      liberar(m_vagas[handle.slot]);
+      m_livres.push_back(handle.slot);
+      return remocao;
+    }
+
+    //índice denso do dado, ou nada se o handle é de um dado que já saiu da mesa
+    [[nodiscard]] std::optional<std::uint32_t> indice(DiceHandle handle) const {
+      if(handle.slot >= m_vagas.size()) return std::nullopt;
+      const auto &vaga{m_vagas[handle.slot]};
+      if(!vaga.ocupada || vaga.geracao != handle.geracao) return std::nullopt;
+      return vaga.indice;
+    }
+
+    //troca os índices densos de dois dados; o chamador troca os dois nos arranjos
+    void trocar(std::uint32_t a, std::uint32_t b) {
+      std::swap(m_vagaDoIndice[a], m_vagaDoIndice[b]);
+      m_vagas[m_vagaDoIndice[a]].indice = a;
+      m_vagas[m_vagaDoIndice[b]].indice = b;
+    }
+
+    [[nodiscard]] DiceHandle handle(std::size_t indice) const {
+      const auto slot{m_vagaDoIndice[indice]};
+      return {slot, m_vagas[slot].geracao};
+    }
+
+  private:
+    struct Vaga {
+      std::uint32_t indice{};
+      std::uint32_t geracao{};
+      bool ocupada{};
+    };
+
+    std::vector<Vaga> m_vagas;
+    std::vector<std::uint32_t> m_livres; //pilha de vagas desocupadas
+    std::vector<std::uint32_t> m_vagaDoIndice; //vaga de cada índice denso
+
+    static void liberar(Vaga &vaga) {
+      vaga.ocupada = false;
+      ++vaga.geracao;
+    }
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "spatialhash.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+//prepara a grade para count dados, com cerca de dois baldes por dado
+void SpatialHash::reset(float cellSize, std::size_t count) {
+  m_invCellSize = 1.0f / cellSize;
+  const auto bucketCount{std::bit_ceil(std::max<std::size_t>(2 * count, 16))};
+  m_mask = static_cast<std::uint32_t>(bucketCount - 1);
+
+  m_buckets.resize(bucketCount);
+  for(auto &bucket : m_buckets) {
+    bucket.clear();
+  }
+  m_entries.assign(count, Entry{});
+}
+
+void SpatialHash::reserve(std::size_t capacidade) {
+  m_entries.reserve(capacidade);
+}
+
+void SpatialHash::insert(std::uint32_t id, glm::vec2 position) {
+  if(id >= m_entries.size()) m_entries.resize(id + 1);
+  auto &entry{m_entries[id]};
+  entry.cell = cellOf(position);
+  entry.bucket = bucketOf(entry.cell);
+  auto &bucket{m_buckets[entry.bucket]};
+  entry.slot = static_cast<std::uint32_t>(bucket.size());
+  bucket.push_back(id);
+}
+
+//só mexe nos baldes se o dado mudou de célula desde a última atualização
+void SpatialHash::update(std::uint32_t id, glm::vec2 position) {
+  if(cellOf(position) == m_entries[id].cell) return;
+  removeFromBucket(id);
+  insert(id, position);
+}
+
+void SpatialHash::remove(std::uint32_t id) {
+  removeFromBucket(id);
+}
+
+void SpatialHash::renumber(std::uint32_t from, std::uint32_t to) {
+  if(from == to) return;
+  const auto entry{m_entries[from]};
+  m_buckets[entry.bucket][entry.slot] = to;
+  m_entries[to] = entry;
+}
+
+void SpatialHash::swap(std::uint32_t a, std::uint32_t b) {
+  if(a == b) return;
+  m_buckets[m_entries[a].bucket][m_entries[a].slot] = b;
+  m_buckets[m_entries[b].bucket][m_entries[b].slot] = a;
+  std::swap(m_entries[a], m_entries[b]);
+}
+
+glm::ivec2 SpatialHash::cellOf(glm::vec2 position) const {
+  return {static_cast<int>(std::floor(position.x * m_invCellSize)),
+          static_cast<int>(std::floor(position.y * m_invCellSize))};
+}
+
+std::uint32_t SpatialHash::bucketOf(glm::ivec2 cell) const {
+  const auto h{(static_cast<std::uint32_t>(cell.x) * 73856093u) ^
+               (static_cast<std::uint32_t>(cell.y) * 19349663u)};
+  return h & m_mask;
+}
+
+//troca o dado pelo último do balde, para remover sem deslocar os demais
+void SpatialHash::removeFromBucket(std::uint32_t id) {
+  const auto &entry{m_entries[id]};
+  auto &bucket{m_buckets[entry.bucket]};
+  const auto last{bucket.back()};
+  bucket[entry.slot] = last;
+  m_entries[last].slot = entry.slot;
+  bucket.pop_back();
+}
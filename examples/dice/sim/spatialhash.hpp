@@ -0,0 +1,56 @@
+#ifndef SPATIALHASH_HPP_
+#define SPATIALHASH_HPP_
+
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <vector>
+
+//grade uniforme com hashing espacial para a fase ampla (broadphase) da detecção de colisões.
+//cada célula tem o tamanho da distância de colisão, então todo vizinho de um dado está nas 3x3 células ao redor.
+//os dados permanecem na grade entre os passos e só trocam de balde quando mudam de célula,
+//de forma que um passo custa proporcionalmente ao número de dados que se moveram
+class SpatialHash {
+  public:
+    void reset(float cellSize, std::size_t count);
+    //prepara as entradas para ids até capacidade - 1 sem realocar; os baldes crescem sob demanda
+    void reserve(std::size_t capacidade);
+    void insert(std::uint32_t id, glm::vec2 position);
+    void update(std::uint32_t id, glm::vec2 position);
+    void remove(std::uint32_t id);
+    //passa a chamar de to o dado que estava como from (depois que a simulação o moveu para outro índice)
+    void renumber(std::uint32_t from, std::uint32_t to);
+    //troca os ids de dois dados que a simulação trocou de índice
+    void swap(std::uint32_t a, std::uint32_t b);
+
+    //chama f(id) para cada dado nas 3x3 células em volta de position, até f retornar false.
+    //células diferentes podem cair no mesmo balde, então um mesmo id pode aparecer mais de uma vez
+    template <typename F>
+    void forEachNear(glm::vec2 position, F &&f) const {
+      const glm::ivec2 center{cellOf(position)};
+      for(int dy{-1}; dy <= 1; ++dy){
+        for(int dx{-1}; dx <= 1; ++dx){
+          for(const auto id : m_buckets[bucketOf(center + glm::ivec2{dx, dy})]){
+            if(!f(id)) return;
+          }
+        }
+      }
+    }
+
+  private:
+    struct Entry {
+      glm::ivec2 cell{};
+      std::uint32_t bucket{};
+      std::uint32_t slot{}; //posição do dado dentro do balde, para remoção em O(1)
+    };
+
+    float m_invCellSize{1.0f};
+    std::uint32_t m_mask{}; //quantidade de baldes - 1 (potência de 2)
+    std::vector<std::vector<std::uint32_t>> m_buckets;
+    std::vector<Entry> m_entries; //indexado pelo id do dado
+
+    [[nodiscard]] glm::ivec2 cellOf(glm::vec2 position) const;
+    [[nodiscard]] std::uint32_t bucketOf(glm::ivec2 cell) const;
+    void removeFromBucket(std::uint32_t id);
+};
+
+#endif
@@ -0,0 +1,93 @@
+#include "threadpool.hpp"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+  if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+  for(unsigned i{0}; i < threads; ++i) m_filas.push_back(std::make_unique<Fila>());
+  for(unsigned i{0}; i < threads; ++i) m_threads.emplace_back(&WorkStealingPool::executar, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    const std::lock_guard trava{m_trava};
+    m_encerrar = true;
+  }
+  m_inicio.notify_all();
+  for(auto &thread : m_threads) thread.join();
+}
+
+void WorkStealingPool::paraCada(std::size_t quantidade, const Tarefa &tarefa) {
+  if(quantidade == 0) return;
+
+  //cada fila começa com uma faixa contígua de tarefas; o roubo corrige o desequilíbrio que sobrar
+  const auto threads{m_filas.size()};
+  for(std::size_t i{0}; i < threads; ++i) {
+    const std::lock_guard trava{m_filas[i]->trava};
+    for(auto t{quantidade * i / threads}; t < quantidade * (i + 1) / threads; ++t) {
+      m_filas[i]->tarefas.push_back(t);
+    }
+  }
+
+  std::unique_lock trava{m_trava};
+  m_tarefa = &tarefa;
+  m_pendentes = quantidade;
+  ++m_geracao;
+  m_inicio.notify_all();
+  //esperar também as threads saírem do lote, para nenhuma levar a tarefa antiga para o próximo
+  m_fim.wait(trava, [this] { return m_pendentes == 0 && m_ativas == 0; });
+  m_tarefa = nullptr;
+}
+
+void WorkStealingPool::executar(unsigned indice) {
+  std::size_t vista{0};
+  while(true) {
+    const Tarefa *tarefa{};
+    {
+      std::unique_lock trava{m_trava};
+      m_inicio.wait(trava, [&] { return m_encerrar || m_geracao != vista; });
+      if(m_encerrar) return;
+      vista = m_geracao;
+      tarefa = m_tarefa;
+      ++m_ativas;
+    }
+
+    std::size_t t{};
+    while(tarefa != nullptr && pegarTarefa(indice, t)) {
+      (*tarefa)(t, indice);
+      --m_pendentes;
+    }
+
+    {
+      const std::lock_guard trava{m_trava};
+      --m_ativas;
+    }
+    m_fim.notify_all();
+  }
+}
+
+//primeiro o fim da própria fila (tarefas vizinhas, ainda quentes na cache), depois o começo das outras
+bool WorkStealingPool::pegarTarefa(unsigned indice, std::size_t &tarefa) {
+  {
+    auto &fila{*m_filas[indice]};
+    const std::lock_guard trava{fila.trava};
+    if(!fila.tarefas.empty()) {
+      tarefa = fila.tarefas.back();
+      fila.tarefas.pop_back();
+      return true;
+    }
+  }
+
+  const auto threads{m_filas.size()};
+  for(std::size_t deslocamento{1}; deslocamento < threads; ++deslocamento) {
+    auto &vitima{*m_filas[(indice + deslocamento) % threads]};
+    const std::lock_guard trava{vitima.trava};
+    if(!vitima.tarefas.empty()) {
+      tarefa = vitima.tarefas.front();
+      vitima.tarefas.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
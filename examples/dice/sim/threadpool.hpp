@@ -0,0 +1,57 @@
+#ifndef THREADPOOL_HPP_
+#define THREADPOOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//conjunto fixo de threads com roubo de tarefas: cada thread tem sua própria fila, consome do fim dela
+//e, quando ela esvazia, rouba do começo da fila de outra thread. Assim lotes que demoram mais
+//(dados que giram por mais tempo) não deixam threads paradas esperando
+class WorkStealingPool {
+  public:
+    using Tarefa = std::function<void(std::size_t tarefa, unsigned thread)>;
+
+    //threads == 0 usa uma thread por núcleo
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    [[nodiscard]] unsigned size() const { return static_cast<unsigned>(m_threads.size()); }
+
+    //executa tarefa(i, thread) para i em [0, quantidade) e só retorna quando todas terminarem.
+    //thread é o índice, em [0, size()), de quem executou, para acumular resultados sem travas
+    void paraCada(std::size_t quantidade, const Tarefa &tarefa);
+
+  private:
+    //alinhada à linha de cache para que as travas de threads vizinhas não disputem a mesma linha
+    struct alignas(64) Fila {
+      std::mutex trava;
+      std::deque<std::size_t> tarefas;
+    };
+
+    std::vector<std::unique_ptr<Fila>> m_filas;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_trava;
+    std::condition_variable m_inicio; //avisa as threads que há um novo lote
+    std::condition_variable m_fim; //avisa paraCada que o lote terminou
+    const Tarefa *m_tarefa{};
+    std::size_t m_geracao{}; //incrementado a cada paraCada, para as threads distinguirem lotes
+    std::atomic<std::size_t> m_pendentes{}; //tarefas do lote atual ainda não concluídas
+    unsigned m_ativas{}; //threads trabalhando no lote atual
+    bool m_encerrar{false};
+
+    void executar(unsigned indice);
+    bool pegarTarefa(unsigned indice, std::size_t &tarefa);
+};
+
+#endif
@@ -0,0 +1,31 @@
+//pré-processa um modelo durante a compilação: lê o .obj, remove vértices repetidos, padroniza a escala,
+//converte para o formato compacto da GPU e grava a malha binária que o exemplo mapeia em memória (abcg::MeshCache), como o bin2h faz com as fontes.
+//uso: dice_bake <modelo.obj> <saida.mesh>
+#include <fmt/core.h>
+
+#include <span>
+
+#include "abcg_exception.hpp"
+#include "abcg_meshcache.hpp"
+#include "model.hpp"
+
+int main(int argc, char **argv) {
+  if(argc != 3) {
+    fmt::print(stderr, "uso: {} <modelo.obj> <saida.mesh>\n", argv[0]);
+    return 1;
+  }
+
+  try {
+    const auto malha{compactar(carregarModelo(argv[1]))};
+    abcg::MeshCache::save(argv[2], hashDoModelo(argv[1]), versaoDoProcessamento, sizeof(VerticeCompacto),
+                          std::as_bytes(std::span{malha.vertices}), malha.indices, malha.tamanhoDoIndice,
+                          malha.niveis);
+    fmt::print("{}: {} vertices, {} niveis de detalhe, {} triangulos no completo, indices de {} bits\n", argv[2],
+               malha.vertices.size(), malha.niveis.size(), malha.niveis.front().indexCount / 3,
+               malha.tamanhoDoIndice * 8);
+  } catch(const abcg::Exception &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
+    return 1;
+  }
+  return 0;
+}